@@ -0,0 +1,59 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_BLOCKINGQUEUE_H
+#define LABS_BLOCKINGQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// Bounded queue between one producer and several consumers.
+template<class T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity) {
+        this->capacity = capacity;
+    }
+
+    void push(T &&item) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        notFull.wait(lock, [this] { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        lock.unlock();
+        notEmpty.notify_one();
+    }
+
+    // false once the queue is closed and drained
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        notEmpty.wait(lock, [this] { return !items.empty() || closed; });
+        if (items.empty())
+            return false;
+
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            closed = true;
+        }
+        notEmpty.notify_all();
+    }
+
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    std::mutex queueMutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+#endif //LABS_BLOCKINGQUEUE_H
@@ -0,0 +1,93 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_CONCURRENTNGRAMMAP_H
+#define LABS_CONCURRENTNGRAMMAP_H
+
+#include <cstdint>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "NGramKey.h"
+#include "ObjectPool.h"
+
+// Insert-or-find map from raw n-gram keys to contexts for many indexing threads.
+// Keys are spread over independently locked stripes. Frequent n-grams like "В" or "."
+// would still serialize on their stripe, so every thread keeps a small direct-mapped
+// cache of contexts it has already seen and goes to the stripe only on a miss.
+// Contexts never move, so cached pointers stay valid.
+class ConcurrentNGramMap {
+public:
+    static const size_t CACHE_SIZE = 4096;
+
+    struct LocalCache {
+        uint64_t keys[CACHE_SIZE] = {};
+        WordContext *contexts[CACHE_SIZE] = {};
+    };
+
+    explicit ConcurrentNGramMap(size_t stripeCount = 1024) : stripes(stripeCount) {
+    }
+
+    // Contexts are taken from the pool of the calling thread.
+    template<class LemmaAt>
+    WordContext *findOrAdd(uint64_t key, int order, LemmaAt lemmaAt, ObjectPool<WordContext> *pool,
+                           LocalCache *cache) {
+        size_t slot = key & (CACHE_SIZE - 1);
+        WordContext *cached = cache->contexts[slot];
+        if (cached && cache->keys[slot] == key && sameLemmas(cached, order, lemmaAt))
+            return cached;
+
+        Stripe &stripe = stripeOf(key);
+        WordContext *context;
+        {
+            lock_guard<mutex> lock(stripe.lock);
+            uint64_t storedKey = key;
+            context = findContext(&stripe.contexts, &storedKey, order, lemmaAt, pool, &stripe.collisions);
+        }
+
+        cache->keys[slot] = key;
+        cache->contexts[slot] = context;
+        return context;
+    }
+
+    // Runs append on a context under the lock of its stripe.
+    template<class Append>
+    void append(uint64_t key, Append append) {
+        Stripe &stripe = stripeOf(key);
+        lock_guard<mutex> lock(stripe.lock);
+        append();
+    }
+
+    // Not thread safe, for use after all inserts.
+    template<class Visit>
+    void forEach(Visit visit) {
+        for (auto &stripe : stripes)
+            for (auto &pairContext : stripe.contexts)
+                visit(pairContext.second);
+    }
+
+    size_t collisions() const {
+        size_t total = 0;
+        for (auto &stripe : stripes)
+            total += stripe.collisions;
+        return total;
+    }
+
+private:
+    // aligned to keep neighbouring stripes off one cache line
+    struct alignas(64) Stripe {
+        mutex lock;
+        unordered_map<uint64_t, WordContext*> contexts;
+        size_t collisions = 0;
+    };
+
+    vector<Stripe> stripes;
+
+    Stripe &stripeOf(uint64_t key) {
+        return stripes[(key >> 40) % stripes.size()];
+    }
+};
+
+#endif //LABS_CONCURRENTNGRAMMAP_H
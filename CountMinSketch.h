@@ -0,0 +1,65 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_COUNTMINSKETCH_H
+#define LABS_COUNTMINSKETCH_H
+
+#include <cstdint>
+#include <vector>
+#include "NGramKey.h"
+
+using namespace std;
+
+// Count-Min sketch of n-gram keys in a fixed amount of memory. Counts are never
+// underestimated, conservative update raises only the rows that hold the minimum,
+// which keeps the overestimate of rare keys small.
+class CountMinSketch {
+public:
+    CountMinSketch(size_t bytes, int depth) {
+        this->depth = max(1, depth);
+        width = 1;
+        while (width * 2 * this->depth * sizeof(uint32_t) <= bytes)
+            width *= 2;
+        counters.assign(width * this->depth, 0);
+    }
+
+    void add(uint64_t key) {
+        uint32_t current = estimate(key);
+        for (int row = 0; row < depth; row++) {
+            uint32_t &counter = cell(key, row);
+            if (counter == current)
+                counter++;
+        }
+    }
+
+    uint32_t estimate(uint64_t key) const {
+        uint32_t minimum = UINT32_MAX;
+        for (int row = 0; row < depth; row++)
+            minimum = min(minimum, cell(key, row));
+        return minimum;
+    }
+
+    size_t bytes() const {
+        return counters.size() * sizeof(uint32_t);
+    }
+
+private:
+    int depth;
+    size_t width;
+    vector<uint32_t> counters;
+
+    size_t column(uint64_t key, int row) const {
+        return mixKey(key + (uint64_t) (row + 1) * 0x9e3779b97f4a7c15ULL) & (width - 1);
+    }
+
+    uint32_t &cell(uint64_t key, int row) {
+        return counters[row * width + column(key, row)];
+    }
+
+    uint32_t cell(uint64_t key, int row) const {
+        return counters[row * width + column(key, row)];
+    }
+};
+
+#endif //LABS_COUNTMINSKETCH_H
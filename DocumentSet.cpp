@@ -0,0 +1,193 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "DocumentSet.h"
+#include "PostingList.h"
+
+#include <algorithm>
+
+DocumentSet::DocumentSet(const uint32_t *docIds, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        auto key = (uint16_t) (docIds[i] >> 16);
+        if (containers.empty() || containers.back().key != key) {
+            if (!containers.empty())
+                containers.back().normalize();
+            containers.emplace_back();
+            containers.back().key = key;
+        }
+        containers.back().values.push_back((uint16_t) docIds[i]);
+        containers.back().cardinality++;
+    }
+    if (!containers.empty())
+        containers.back().normalize();
+}
+
+bool DocumentSet::Container::contains(uint16_t low) const {
+    if (isBitmap())
+        return (bits[low / 64] >> (low % 64)) & 1;
+    return binary_search(values.begin(), values.end(), low);
+}
+
+void DocumentSet::Container::normalize() {
+    if (!isBitmap() && cardinality > ARRAY_LIMIT) {
+        bits.assign(BITMAP_WORDS, 0);
+        for (uint16_t low : values)
+            bits[low / 64] |= (uint64_t) 1 << (low % 64);
+        values = {};
+    } else if (isBitmap() && cardinality <= ARRAY_LIMIT) {
+        values.clear();
+        for (size_t word = 0; word < BITMAP_WORDS; word++)
+            for (uint64_t w = bits[word]; w != 0; w &= w - 1)
+                values.push_back((uint16_t) (word * 64 + __builtin_ctzll(w)));
+        bits = {};
+    }
+}
+
+const DocumentSet::Container *DocumentSet::find(uint16_t key) const {
+    auto found = lower_bound(containers.begin(), containers.end(), key,
+                             [](const Container &container, uint16_t k) { return container.key < k; });
+    return found != containers.end() && found->key == key ? &*found : nullptr;
+}
+
+bool DocumentSet::contains(uint32_t docId) const {
+    const Container *container = find((uint16_t) (docId >> 16));
+    return container && container->contains((uint16_t) docId);
+}
+
+size_t DocumentSet::size() const {
+    size_t total = 0;
+    for (const auto &container : containers)
+        total += container.cardinality;
+    return total;
+}
+
+size_t DocumentSet::collect(uint32_t from, size_t count, uint32_t *docIds) const {
+    size_t written = 0;
+    auto container = lower_bound(containers.begin(), containers.end(), (uint16_t) (from >> 16),
+                                 [](const Container &c, uint16_t k) { return c.key < k; });
+    for (; container != containers.end() && written < count; ++container) {
+        uint32_t high = (uint32_t) container->key << 16;
+        // the first container may start below from
+        uint32_t low = high < from ? from - high : 0;
+        if (container->isBitmap()) {
+            for (size_t word = low / 64; word < BITMAP_WORDS && written < count; word++) {
+                uint64_t w = container->bits[word];
+                if (word == low / 64)
+                    w &= ~(uint64_t) 0 << (low % 64);
+                for (; w != 0 && written < count; w &= w - 1)
+                    docIds[written++] = high | (uint32_t) (word * 64 + __builtin_ctzll(w));
+            }
+        } else {
+            auto value = lower_bound(container->values.begin(), container->values.end(), low);
+            for (; value != container->values.end() && written < count; ++value)
+                docIds[written++] = high | *value;
+        }
+    }
+    return written;
+}
+
+vector<uint32_t> DocumentSet::toVector() const {
+    vector<uint32_t> docIds(size());
+    collect(0, docIds.size(), docIds.data());
+    return docIds;
+}
+
+DocumentSet::Container DocumentSet::intersect(const Container &a, const Container &b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        result.bits.resize(BITMAP_WORDS);
+        for (size_t word = 0; word < BITMAP_WORDS; word++) {
+            result.bits[word] = a.bits[word] & b.bits[word];
+            result.cardinality += __builtin_popcountll(result.bits[word]);
+        }
+    } else if (a.isBitmap() || b.isBitmap()) {
+        const Container &array = a.isBitmap() ? b : a;
+        const Container &bitmap = a.isBitmap() ? a : b;
+        for (uint16_t low : array.values)
+            if ((bitmap.bits[low / 64] >> (low % 64)) & 1)
+                result.values.push_back(low);
+        result.cardinality = (uint32_t) result.values.size();
+    } else {
+        // the smaller array gallops through the larger one
+        const auto &small = a.values.size() <= b.values.size() ? a.values : b.values;
+        const auto &large = a.values.size() <= b.values.size() ? b.values : a.values;
+        auto next = large.begin();
+        for (uint16_t low : small) {
+            next = gallop(next, large.end(), low, less<uint16_t>());
+            if (next == large.end())
+                break;
+            if (*next == low)
+                result.values.push_back(low);
+        }
+        result.cardinality = (uint32_t) result.values.size();
+    }
+    result.normalize();
+    return result;
+}
+
+DocumentSet::Container DocumentSet::unite(const Container &a, const Container &b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() || b.isBitmap()) {
+        result.bits = a.isBitmap() ? a.bits : b.bits;
+        const Container &other = a.isBitmap() ? b : a;
+        if (other.isBitmap()) {
+            for (size_t word = 0; word < BITMAP_WORDS; word++)
+                result.bits[word] |= other.bits[word];
+        } else {
+            for (uint16_t low : other.values)
+                result.bits[low / 64] |= (uint64_t) 1 << (low % 64);
+        }
+        for (uint64_t word : result.bits)
+            result.cardinality += __builtin_popcountll(word);
+    } else {
+        set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                  back_inserter(result.values));
+        result.cardinality = (uint32_t) result.values.size();
+    }
+    result.normalize();
+    return result;
+}
+
+DocumentSet DocumentSet::intersect(const DocumentSet &a, const DocumentSet &b) {
+    DocumentSet result;
+    auto first = a.containers.begin(), second = b.containers.begin();
+    while (first != a.containers.end() && second != b.containers.end()) {
+        if (first->key < second->key) {
+            ++first;
+        } else if (second->key < first->key) {
+            ++second;
+        } else {
+            Container container = intersect(*first, *second);
+            if (container.cardinality > 0)
+                result.containers.push_back(std::move(container));
+            ++first;
+            ++second;
+        }
+    }
+    return result;
+}
+
+DocumentSet DocumentSet::unite(const DocumentSet &a, const DocumentSet &b) {
+    DocumentSet result;
+    auto first = a.containers.begin(), second = b.containers.begin();
+    while (first != a.containers.end() || second != b.containers.end()) {
+        if (second == b.containers.end() || (first != a.containers.end() && first->key < second->key)) {
+            result.containers.push_back(*first++);
+        } else if (first == a.containers.end() || second->key < first->key) {
+            result.containers.push_back(*second++);
+        } else {
+            result.containers.push_back(unite(*first++, *second++));
+        }
+    }
+    return result;
+}
+
+size_t DocumentSet::bytes() const {
+    size_t total = sizeof(DocumentSet) + containers.capacity() * sizeof(Container);
+    for (const auto &container : containers)
+        total += container.values.capacity() * sizeof(uint16_t) + container.bits.capacity() * sizeof(uint64_t);
+    return total;
+}
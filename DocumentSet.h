@@ -0,0 +1,65 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_DOCUMENTSET_H
+#define LABS_DOCUMENTSET_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Roaring-style set of document ids: ids are grouped by their high 16 bits, and every
+// group is a sorted array of the low 16 bits while it has up to 4096 ids, a 65536-bit
+// bitmap above that. Intersection and union work group by group with a separate loop
+// for every pair of group kinds.
+class DocumentSet {
+public:
+    DocumentSet() = default;
+
+    // docIds ascending without repeats
+    DocumentSet(const uint32_t *docIds, size_t count);
+
+    bool contains(uint32_t docId) const;
+
+    size_t size() const;
+
+    // Up to count ids >= from in order, returns how many were written.
+    size_t collect(uint32_t from, size_t count, uint32_t *docIds) const;
+
+    vector<uint32_t> toVector() const;
+
+    static DocumentSet intersect(const DocumentSet &a, const DocumentSet &b);
+    static DocumentSet unite(const DocumentSet &a, const DocumentSet &b);
+
+    size_t bytes() const;
+
+private:
+    static constexpr size_t ARRAY_LIMIT = 4096;
+    static constexpr size_t BITMAP_WORDS = 65536 / 64;
+
+    struct Container {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        // one of the two is used
+        vector<uint16_t> values;
+        vector<uint64_t> bits;
+
+        bool isBitmap() const {
+            return !bits.empty();
+        }
+
+        bool contains(uint16_t low) const;
+        // to the kind that suits the cardinality
+        void normalize();
+    };
+
+    vector<Container> containers;
+
+    const Container *find(uint16_t key) const;
+    static Container intersect(const Container &a, const Container &b);
+    static Container unite(const Container &a, const Container &b);
+};
+
+#endif //LABS_DOCUMENTSET_H
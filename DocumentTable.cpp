@@ -0,0 +1,42 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "DocumentTable.h"
+
+#include <algorithm>
+
+bool TextBoundaries::sameSentence(uint32_t first, uint32_t last) const {
+    auto next = upper_bound(sentences.begin(), sentences.end(), first);
+    return next == sentences.end() || *next > last;
+}
+
+uint32_t DocumentTable::add(const string &name, uint32_t length, const TextBoundaries &boundaries) {
+    names.push_back(name);
+    lengths.push_back(length);
+    totalLength += length;
+
+    for (uint32_t offset : boundaries.sentences)
+        if (offset < length)
+            sentenceStarts.push_back(offset);
+    sentenceOffsets.push_back((uint32_t) sentenceStarts.size());
+
+    for (uint32_t offset : boundaries.paragraphs)
+        if (offset < length)
+            paragraphStarts.push_back(offset);
+    paragraphOffsets.push_back((uint32_t) paragraphStarts.size());
+
+    return (uint32_t) names.size() - 1;
+}
+
+double DocumentTable::averageLength() const {
+    return (double) totalLength / (double) names.size();
+}
+
+bool DocumentTable::withinSpan(const vector<uint32_t> &starts, const vector<uint32_t> &offsets,
+                               uint32_t docId, uint32_t first, uint32_t last) {
+    auto begin = starts.begin() + offsets[docId];
+    auto end = starts.begin() + offsets[docId + 1];
+    auto next = upper_bound(begin, end, first);
+    return next == end || *next > last;
+}
@@ -0,0 +1,92 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_DOCUMENTTABLE_H
+#define LABS_DOCUMENTTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Token offsets where sentences and paragraphs start, collected while a document is tokenized.
+// Offset 0 is implicit.
+struct TextBoundaries {
+    vector<uint32_t> sentences;
+    vector<uint32_t> paragraphs;
+
+    void markSentence(uint32_t offset) {
+        if (offset > 0 && (sentences.empty() || sentences.back() < offset))
+            sentences.push_back(offset);
+    }
+
+    void markParagraph(uint32_t offset) {
+        markSentence(offset);
+        if (offset > 0 && (paragraphs.empty() || paragraphs.back() < offset))
+            paragraphs.push_back(offset);
+    }
+
+    void clear() {
+        sentences.clear();
+        paragraphs.clear();
+    }
+
+    bool sameSentence(uint32_t first, uint32_t last) const;
+};
+
+// Maps dense document ids to paths, lengths and sentence/paragraph boundaries.
+// The index stores only ids, paths are needed for output.
+class DocumentTable {
+public:
+    uint32_t add(const string &name, uint32_t length, const TextBoundaries &boundaries);
+
+    const string &name(uint32_t docId) const {
+        return names[docId];
+    }
+
+    uint32_t length(uint32_t docId) const {
+        return lengths[docId];
+    }
+
+    uint32_t size() const {
+        return (uint32_t) names.size();
+    }
+
+    double averageLength() const;
+
+    // Both checks take token positions first <= last of the same document.
+    bool sameSentence(uint32_t docId, uint32_t first, uint32_t last) const {
+        return withinSpan(sentenceStarts, sentenceOffsets, docId, first, last);
+    }
+
+    bool sameParagraph(uint32_t docId, uint32_t first, uint32_t last) const {
+        return withinSpan(paragraphStarts, paragraphOffsets, docId, first, last);
+    }
+
+    uint32_t sentenceCount(uint32_t docId) const {
+        return sentenceOffsets[docId + 1] - sentenceOffsets[docId] + 1;
+    }
+
+    uint32_t paragraphCount(uint32_t docId) const {
+        return paragraphOffsets[docId + 1] - paragraphOffsets[docId] + 1;
+    }
+
+private:
+    vector<string> names;
+    vector<uint32_t> lengths;
+    uint64_t totalLength = 0;
+
+    // boundaries of all documents back to back, document i owns [offsets[i], offsets[i + 1])
+    vector<uint32_t> sentenceStarts;
+    vector<uint32_t> sentenceOffsets{0};
+    vector<uint32_t> paragraphStarts;
+    vector<uint32_t> paragraphOffsets{0};
+
+    static bool withinSpan(const vector<uint32_t> &starts, const vector<uint32_t> &offsets,
+                           uint32_t docId, uint32_t first, uint32_t last);
+};
+
+
+#endif //LABS_DOCUMENTTABLE_H
@@ -1,5 +0,0 @@
-//
-// Created by Roman Titkov on 05.05.2022.
-//
-
-#include "Entry.h"
@@ -0,0 +1,71 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "FMIndex.h"
+
+void FMIndex::build(const SuffixArray &suffixArray, uint32_t sampleRate) {
+    this->sampleRate = max((uint32_t) 1, sampleRate);
+    size_t n = suffixArray.size();
+
+    // the symbol before every suffix, the text wraps around
+    vector<uint32_t> lastColumn(n);
+    uint32_t maxSymbol = 0;
+    for (size_t rank = 0; rank < n; rank++) {
+        uint32_t position = suffixArray.suffix(rank);
+        lastColumn[rank] = (uint32_t) suffixArray.symbol(position > 0 ? position - 1 : n - 1);
+        maxSymbol = max(maxSymbol, lastColumn[rank]);
+    }
+
+    symbolStarts.assign(maxSymbol + 2, 0);
+    for (uint32_t symbol : lastColumn)
+        symbolStarts[symbol + 1]++;
+    for (size_t symbol = 1; symbol < symbolStarts.size(); symbol++)
+        symbolStarts[symbol] += symbolStarts[symbol - 1];
+
+    // position 0 is always sampled, so LF steps stop before wrapping around
+    sampled = RankBitVector(n);
+    samples.clear();
+    for (size_t rank = 0; rank < n; rank++) {
+        uint32_t position = suffixArray.suffix(rank);
+        if (position % this->sampleRate == 0) {
+            sampled.set(rank);
+            samples.push_back(position);
+        }
+    }
+    sampled.buildRanks();
+    samples.shrink_to_fit();
+
+    bwt.build(std::move(lastColumn), maxSymbol);
+    starts = suffixArray.documentStarts();
+}
+
+pair<size_t, size_t> FMIndex::find(const uint32_t *lemmaIds, size_t count) const {
+    size_t begin = 0, end = size();
+    for (size_t i = count; i > 0 && begin < end; i--) {
+        uint32_t symbol = lemmaIds[i - 1] + 2;
+        if (symbol + 1 >= symbolStarts.size())
+            return {0, 0};
+        begin = symbolStarts[symbol] + bwt.rank(symbol, begin);
+        end = symbolStarts[symbol] + bwt.rank(symbol, end);
+    }
+    return begin < end ? make_pair(begin, end) : make_pair((size_t) 0, (size_t) 0);
+}
+
+uint32_t FMIndex::locate(size_t rank) const {
+    uint32_t steps = 0;
+    while (!sampled.get(rank)) {
+        rank = lastToFirst(rank);
+        steps++;
+    }
+    return samples[sampled.rank1(rank)] + steps;
+}
+
+vector<pair<uint32_t, uint32_t>> FMIndex::occurrences(const uint32_t *lemmaIds, size_t count,
+                                                      const DocumentTable &documents) const {
+    auto range = find(lemmaIds, count);
+    vector<uint32_t> positions;
+    for (size_t rank = range.first; rank < range.second; rank++)
+        positions.push_back(locate(rank));
+    return SuffixArray::countByDocument(positions, (uint32_t) count, starts, documents);
+}
@@ -0,0 +1,63 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_FMINDEX_H
+#define LABS_FMINDEX_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "DocumentTable.h"
+#include "RankBitVector.h"
+#include "SuffixArray.h"
+#include "WaveletMatrix.h"
+
+using namespace std;
+
+// Compressed self-index of the corpus lemma stream: the Burrows-Wheeler transform of
+// the text of a SuffixArray in a wavelet matrix, and every sampleRate-th text position
+// of the suffix array. Counting a phrase takes two wavelet ranks per lemma, locating an
+// occurrence at most sampleRate LF steps. The suffix array is not needed afterwards.
+class FMIndex {
+public:
+    void build(const SuffixArray &suffixArray, uint32_t sampleRate);
+
+    // Suffixes that start with lemmaIds, by backward search.
+    pair<size_t, size_t> find(const uint32_t *lemmaIds, size_t count) const;
+
+    // Text position of the suffix of the given rank.
+    uint32_t locate(size_t rank) const;
+
+    // As SuffixArray::occurrences.
+    vector<pair<uint32_t, uint32_t>> occurrences(const uint32_t *lemmaIds, size_t count,
+                                                 const DocumentTable &documents) const;
+
+    size_t size() const {
+        return bwt.size();
+    }
+
+    size_t bytes() const {
+        return bwt.bytes() + symbolStarts.capacity() * sizeof(uint32_t) + sampled.bytes() +
+               samples.capacity() * sizeof(uint32_t) + starts.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    WaveletMatrix bwt;
+    // suffixes that start with a smaller symbol
+    vector<uint32_t> symbolStarts;
+    // suffix ranks with a sampled position, and the positions in rank order
+    RankBitVector sampled;
+    vector<uint32_t> samples;
+    uint32_t sampleRate = 32;
+    // where every document starts in the text
+    vector<uint32_t> starts;
+
+    // rank of the suffix one text position to the left
+    size_t lastToFirst(size_t rank) const {
+        uint32_t symbol = bwt.access(rank);
+        return symbolStarts[symbol] + bwt.rank(symbol, rank);
+    }
+};
+
+#endif //LABS_FMINDEX_H
@@ -0,0 +1,74 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "ImpactIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ImpactIndex::build(const unordered_map<uint64_t, PostingList> &postings,
+                        const function<double(uint32_t, uint32_t, size_t)> &score) {
+    lists.clear();
+    vector<pair<double, uint32_t>> scores;
+    vector<pair<uint8_t, uint32_t>> impacts;
+    vector<uint32_t> gaps;
+    uint32_t docIds[PostingList::BLOCK_SIZE], counts[PostingList::BLOCK_SIZE];
+    for (const auto &pairPostings : postings) {
+        const PostingList &postingList = pairPostings.second;
+        scores.clear();
+        double maxScore = 0;
+        for (size_t block = 0; block < postingList.blockCount(); block++) {
+            size_t count = postingList.decodeBlock(block, docIds, counts);
+            for (size_t i = 0; i < count; i++) {
+                // entries without positions were only added for thesaurus relations
+                if (counts[i] == 0)
+                    continue;
+                scores.emplace_back(score(docIds[i], counts[i], postingList.size()), docIds[i]);
+                maxScore = max(maxScore, scores.back().first);
+            }
+        }
+        if (scores.empty())
+            continue;
+
+        // impact descending, documents ascending inside one impact
+        double step = maxScore / 255;
+        impacts.clear();
+        for (const auto &scorePair : scores)
+            impacts.emplace_back(quantize(scorePair.first, step), scorePair.second);
+        sort(impacts.begin(), impacts.end(), [](const pair<uint8_t, uint32_t> &a, const pair<uint8_t, uint32_t> &b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+
+        ImpactList &list = lists[pairPostings.first];
+        list.step = step;
+        for (size_t begin = 0, end; begin < impacts.size(); begin = end) {
+            end = begin;
+            gaps.clear();
+            while (end < impacts.size() && impacts[end].first == impacts[begin].first)
+                gaps.push_back(impacts[end++].second);
+            PostingCodec::toGaps(gaps.data(), gaps.size(), 0);
+            list.segments.push_back({impacts[begin].first, (uint32_t) gaps.size(), (uint32_t) list.data.size()});
+            PostingCodec::encode(gaps.data(), gaps.size(), &list.data);
+        }
+        list.segments.shrink_to_fit();
+        list.data.shrink_to_fit();
+    }
+}
+
+void ImpactIndex::decodeSegment(const ImpactList &list, size_t segment, vector<uint32_t> *docIds) {
+    const Segment &found = list.segments[segment];
+    docIds->resize(found.count);
+    const uint8_t *in = &list.data[found.offset];
+    for (size_t begin = 0; begin < found.count; begin += PostingCodec::BLOCK_SIZE)
+        in = PostingCodec::decodeBlock(in, min(PostingCodec::BLOCK_SIZE, found.count - begin), docIds->data() + begin);
+    PostingCodec::fromGaps(docIds->data(), found.count, 0);
+}
+
+size_t ImpactIndex::bytes() const {
+    size_t total = 0;
+    for (const auto &pairList : lists)
+        total += sizeof(uint64_t) + sizeof(ImpactList) + pairList.second.segments.capacity() * sizeof(Segment) +
+                 pairList.second.data.capacity();
+    return total;
+}
@@ -0,0 +1,73 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_IMPACTINDEX_H
+#define LABS_IMPACTINDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "PostingList.h"
+
+using namespace std;
+
+// Postings with the BM25 score of every document precomputed and quantized to 8 bits.
+// Documents of one n-gram are grouped by that impact, highest first, so a query can take
+// the best-scoring postings of all its terms first and stop early. Scores of different
+// n-grams lie orders of magnitude apart, so every n-gram splits its own largest score into
+// 255 steps; impact 0 is a score of 0.
+class ImpactIndex {
+public:
+    struct Segment {
+        uint8_t impact;
+        uint32_t count;
+        // where its document id gaps start in data
+        uint32_t offset;
+    };
+
+    struct ImpactList {
+        vector<Segment> segments;
+        vector<uint8_t> data;
+        // score of one impact step
+        double step;
+
+        double score(uint8_t impact) const {
+            return impact * step;
+        }
+    };
+
+    // Impact of a score in a list whose step is step.
+    static uint8_t quantize(double score, double step) {
+        if (score <= 0)
+            return 0;
+        return (uint8_t) max(1L, min(255L, lround(score / step)));
+    }
+
+    // score(docId, count, df) is the exact BM25 of a posting with weight 1.
+    void build(const unordered_map<uint64_t, PostingList> &postings,
+               const function<double(uint32_t, uint32_t, size_t)> &score);
+
+    // nullptr when the n-gram has no postings
+    const ImpactList *find(uint64_t key) const {
+        auto found = lists.find(key);
+        return found == lists.end() ? nullptr : &found->second;
+    }
+
+    // Document ids of a segment, ascending.
+    static void decodeSegment(const ImpactList &list, size_t segment, vector<uint32_t> *docIds);
+
+    size_t size() const {
+        return lists.size();
+    }
+
+    size_t bytes() const;
+
+private:
+    unordered_map<uint64_t, ImpactList> lists;
+};
+
+#endif //LABS_IMPACTINDEX_H
@@ -0,0 +1,28 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "LemmaTable.h"
+
+atomic<uint32_t> LemmaTable::tables{0};
+
+uint32_t LemmaTable::id(const wstring &lemma) {
+    auto found = ids.find(lemma);
+    if (found != ids.end())
+        return found->second;
+
+    auto lemmaId = (uint32_t) lemmas.size();
+    ids.emplace(lemma, lemmaId);
+    lemmas.push_back(lemma);
+    return lemmaId;
+}
+
+wstring LemmaTable::text(const vector<uint32_t> &lemmaIds) const {
+    wstring result;
+    for (uint32_t lemmaId : lemmaIds) {
+        if (!result.empty())
+            result += L' ';
+        result += lemmas[lemmaId];
+    }
+    return result;
+}
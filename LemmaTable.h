@@ -0,0 +1,54 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_LEMMATABLE_H
+#define LABS_LEMMATABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "dictionary.h"
+
+using namespace std;
+
+// Dense ids of lemma strings. The id of a Word is cached in Word::lemmaId,
+// so the string is hashed once per lemma and not once per token. Words are shared
+// by every index built from one dictionary, so the cache is tagged with the serial
+// of the table that filled it and a different table looks the lemma up again.
+class LemmaTable {
+public:
+    LemmaTable() : serial(++tables) {}
+
+    uint32_t id(Word *word) {
+        if (word->lemmaTable != serial) {
+            word->lemmaId = (int) id(word->word);
+            word->lemmaTable = serial;
+        }
+        return (uint32_t) word->lemmaId;
+    }
+
+    uint32_t id(const wstring &lemma);
+
+    const wstring &lemma(uint32_t lemmaId) const {
+        return lemmas[lemmaId];
+    }
+
+    uint32_t size() const {
+        return (uint32_t) lemmas.size();
+    }
+
+    // lemmas of an n-gram joined with spaces, for output only
+    wstring text(const vector<uint32_t> &lemmaIds) const;
+
+private:
+    static atomic<uint32_t> tables;
+    uint32_t serial;
+    unordered_map<wstring, uint32_t> ids;
+    vector<wstring> lemmas;
+};
+
+
+#endif //LABS_LEMMATABLE_H
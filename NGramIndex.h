@@ -0,0 +1,136 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_NGRAMINDEX_H
+#define LABS_NGRAMINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "WordContext.h"
+#include "DocumentTable.h"
+#include "LemmaTable.h"
+#include "NGramTrie.h"
+#include "ObjectPool.h"
+#include "PostingList.h"
+#include "SuffixArray.h"
+#include "FMIndex.h"
+#include "ImpactIndex.h"
+
+using namespace std;
+
+enum IndexBuildMode {
+    // every thread fills its own partial index, partitions are merged at the end
+    PARTIAL_INDEXES,
+    // all threads insert into one ConcurrentNGramMap
+    SHARED_MAP,
+    // occurrences are radix-sorted by key in runs and scanned into postings,
+    // orders up to 15
+    SORT_BASED
+};
+
+struct IndexSettings {
+    int maxOrder = 3;
+    bool filterDuplicates = true;
+    // n-grams of 2 and more words found in fewer than minDf or in more than maxDfRatio
+    // of all documents are dropped before their postings are built, topKPerOrder > 0
+    // keeps only that many most frequent n-grams of every such order; single words and
+    // thesaurus n-grams are always kept
+    size_t minDf = 1;
+    double maxDfRatio = 1.0;
+    size_t topKPerOrder = 0;
+    // with sketchBytes > 0 and minDf > 1 a pre-pass counts document frequencies of
+    // higher-order n-grams in a Count-Min sketch of that size, and the indexing pass
+    // does not create n-grams the sketch puts below minDf
+    size_t sketchBytes = 0;
+    int sketchDepth = 4;
+    // n-gram indexing threads, tokenization always runs on the calling thread
+    int threads = max(1, (int) thread::hardware_concurrency());
+    IndexBuildMode buildMode = PARTIAL_INDEXES;
+    // occurrences per run of the sort-based build, 16 bytes each and as much again to sort
+    size_t sortRunSize = 1 << 18;
+    // document ids of n-grams found in at least this share of documents are stored
+    // as a DocumentSet, of the others as compressed gaps
+    double bitmapDfRatio = 1.0 / 16;
+    // keep the lemma stream of the corpus and build a SuffixArray over it
+    bool buildSuffixArray = false;
+    // the same stream as an FMIndex, which samples every fmSampleRate-th position; it
+    // serves quoted phrases only and is kept next to the postings, not instead of them
+    bool buildFmIndex = false;
+    uint32_t fmSampleRate = 32;
+    // BM25 impacts of all postings for rankByImpact
+    bool buildImpacts = false;
+    // with championListSize > 0 every n-gram keeps that many best documents by BM25
+    // for rankByChampions
+    size_t championListSize = 0;
+};
+
+// Best documents of one n-gram by BM25 with weight 1, in document id order.
+struct ChampionList {
+    vector<uint32_t> docIds;
+    vector<uint32_t> counts;
+    // largest score of a document left out, 0 when the list has them all
+    double rest = 0;
+};
+
+// Everything built from the corpus. Contexts and entries are owned by the pools.
+struct NGramIndex {
+    DocumentTable documents;
+    LemmaTable lemmas;
+    unordered_map<uint64_t, WordContext*> phraseContexts;
+    // the same n-grams by lemma path, for request lookup
+    NGramTrie trie;
+    // compressed documents and positions of every n-gram that has entries
+    unordered_map<uint64_t, PostingList> postings;
+    // empty unless IndexSettings::buildSuffixArray
+    SuffixArray suffixArray;
+    // empty unless IndexSettings::buildFmIndex
+    FMIndex fmIndex;
+    // empty unless IndexSettings::buildImpacts
+    ImpactIndex impacts;
+    // empty unless IndexSettings::championListSize > 0, same keys as postings
+    unordered_map<uint64_t, ChampionList> champions;
+    // thesaurus relations: stored key of an n-gram -> stored keys of related n-grams
+    unordered_map<uint64_t, vector<pair<uint64_t, bool>>> relations;
+    size_t collisions = 0;
+    size_t pruned = 0;
+
+    ObjectPool<WordContext> contextPool;
+    vector<unique_ptr<ObjectPool<WordContext>>> partialPools;
+
+    // Bytes of the contexts and their keys, allocator overhead is not counted.
+    size_t contextBytes() const {
+        size_t bytes = 0;
+        for (const auto &pairContext : phraseContexts) {
+            const WordContext *context = pairContext.second;
+            bytes += sizeof(uint64_t) + sizeof(WordContext*) + sizeof(WordContext) +
+                     context->lemmas.capacity() * sizeof(uint32_t) +
+                     context->textEntries.capacity() * sizeof(pair<uint32_t, vector<int>>);
+        }
+        return bytes;
+    }
+
+    size_t postingBytes() const {
+        size_t bytes = 0;
+        for (const auto &pairPostings : postings)
+            bytes += sizeof(uint64_t) + pairPostings.second.bytes();
+        return bytes;
+    }
+
+    // Everything the requests are served from: the FM-index and the suffix array
+    // come on top of the postings, they do not replace them.
+    size_t bytes() const {
+        size_t bytes = contextBytes() + postingBytes() + trie.bytes() + suffixArray.bytes() +
+                       fmIndex.bytes() + impacts.bytes();
+        for (const auto &pairChampions : champions)
+            bytes += sizeof(uint64_t) + sizeof(ChampionList) +
+                     (pairChampions.second.docIds.capacity() + pairChampions.second.counts.capacity()) *
+                     sizeof(uint32_t);
+        return bytes;
+    }
+};
+
+#endif //LABS_NGRAMINDEX_H
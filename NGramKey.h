@@ -0,0 +1,86 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_NGRAMKEY_H
+#define LABS_NGRAMKEY_H
+
+#include <cstdint>
+#include <unordered_map>
+#include "WordContext.h"
+#include "ObjectPool.h"
+
+// 64-bit n-gram keys. A key is built right to left: the key of "A B C" is
+// prependLemma(key of "B C", A), so all orders ending at one token share the work.
+inline uint64_t mixKey(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t prependLemma(uint64_t key, uint32_t lemmaId) {
+    return mixKey(key * 0x9e3779b97f4a7c15ULL + lemmaId + 1);
+}
+
+inline uint64_t ngramKey(const vector<uint32_t> &lemmaIds) {
+    uint64_t key = 0;
+    for (size_t i = lemmaIds.size(); i > 0; i--)
+        key = prependLemma(key, lemmaIds[i - 1]);
+    return key;
+}
+
+// Two different n-grams with one hash: the later one moves to the next probe key.
+inline uint64_t nextProbe(uint64_t key) {
+    return mixKey(key + 0x632be59bd9b4e019ULL);
+}
+
+template<class LemmaAt>
+bool sameLemmas(const WordContext *context, int order, LemmaAt lemmaAt) {
+    if (context->lemmas.size() != (size_t) order)
+        return false;
+    for (int i = 0; i < order; i++)
+        if (context->lemmas[i] != lemmaAt(i))
+            return false;
+    return true;
+}
+
+// Finds the n-gram whose i-th lemma id is lemmaAt(i) and replaces *key with the
+// key it is stored under, or with the first free key when there is no such n-gram.
+// Only reads NGrams, so it can be shared by threads.
+template<class LemmaAt>
+WordContext *lookupContext(const unordered_map<uint64_t, WordContext*> &NGrams, uint64_t *key,
+                           int order, LemmaAt lemmaAt, size_t *collisions = nullptr) {
+    while (true) {
+        auto found = NGrams.find(*key);
+        if (found == NGrams.end())
+            return nullptr;
+        if (sameLemmas(found->second, order, lemmaAt))
+            return found->second;
+
+        *key = nextProbe(*key);
+        if (collisions)
+            (*collisions)++;
+    }
+}
+
+// As lookupContext, but a missing n-gram is taken from pool when one is given.
+template<class LemmaAt>
+WordContext *findContext(unordered_map<uint64_t, WordContext*> *NGrams, uint64_t *key,
+                         int order, LemmaAt lemmaAt, ObjectPool<WordContext> *pool,
+                         size_t *collisions = nullptr) {
+    WordContext *found = lookupContext(*NGrams, key, order, lemmaAt, collisions);
+    if (found || !pool)
+        return found;
+
+    auto context = pool->create();
+    context->lemmas.reserve(order);
+    for (int i = 0; i < order; i++)
+        context->lemmas.push_back(lemmaAt(i));
+    NGrams->emplace(*key, context);
+    return context;
+}
+
+#endif //LABS_NGRAMKEY_H
@@ -0,0 +1,75 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "NGramTrie.h"
+
+#include <algorithm>
+#include <deque>
+
+void NGramTrie::build(const unordered_map<uint64_t, WordContext*> &contexts,
+                      const unordered_map<uint64_t, PostingList> &postings) {
+    vector<pair<const vector<uint32_t>*, uint64_t>> ngrams;
+    ngrams.reserve(postings.size());
+    for (const auto &pairPostings : postings)
+        ngrams.emplace_back(&contexts.at(pairPostings.first)->lemmas, pairPostings.first);
+    sort(ngrams.begin(), ngrams.end(), [](const auto &a, const auto &b) { return *a.first < *b.first; });
+
+    nodes.clear();
+    keys.clear();
+    nodes.push_back({0, 0, 0, NO_NGRAM});
+
+    // a node with the n-grams that start with its path, ngrams[begin, end)
+    struct Range {
+        uint32_t node;
+        size_t depth, begin, end;
+    };
+    deque<Range> queue{{0, 0, 0, ngrams.size()}};
+    while (!queue.empty()) {
+        Range range = queue.front();
+        queue.pop_front();
+
+        // the shorter n-gram sorts first, it is the path itself
+        size_t begin = range.begin;
+        if (begin < range.end && ngrams[begin].first->size() == range.depth) {
+            nodes[range.node].ngram = (uint32_t) keys.size();
+            keys.push_back(ngrams[begin].second);
+            begin++;
+        }
+
+        nodes[range.node].firstChild = (uint32_t) nodes.size();
+        while (begin < range.end) {
+            uint32_t lemmaId = (*ngrams[begin].first)[range.depth];
+            size_t end = begin + 1;
+            while (end < range.end && (*ngrams[end].first)[range.depth] == lemmaId)
+                end++;
+
+            queue.push_back({(uint32_t) nodes.size(), range.depth + 1, begin, end});
+            nodes.push_back({lemmaId, 0, 0, NO_NGRAM});
+            nodes[range.node].childCount++;
+            begin = end;
+        }
+    }
+    nodes.shrink_to_fit();
+    keys.shrink_to_fit();
+}
+
+const NGramTrie::Node *NGramTrie::child(const Node &node, uint32_t lemmaId) const {
+    auto first = nodes.begin() + node.firstChild;
+    auto last = first + node.childCount;
+    auto found = lower_bound(first, last, lemmaId, [](const Node &child, uint32_t id) { return child.lemmaId < id; });
+    return found != last && found->lemmaId == lemmaId ? &*found : nullptr;
+}
+
+int NGramTrie::longestMatch(const uint32_t *lemmaIds, int count, uint64_t *key) const {
+    int order = 0;
+    const Node *node = nodes.empty() ? nullptr : &nodes[0];
+    for (int depth = 0; node && depth < count; depth++) {
+        node = child(*node, lemmaIds[depth]);
+        if (node && node->ngram != NO_NGRAM) {
+            order = depth + 1;
+            *key = keys[node->ngram];
+        }
+    }
+    return order;
+}
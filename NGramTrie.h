@@ -0,0 +1,56 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_NGRAMTRIE_H
+#define LABS_NGRAMTRIE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "PostingList.h"
+#include "WordContext.h"
+
+using namespace std;
+
+// Static trie of the indexed n-grams over lemma ids, so "КАК СТАТЬ" and
+// "КАК СТАТЬ РАЗРАБОТЧИК" share the path of "КАК СТАТЬ". Nodes are stored in
+// breadth-first order, the children of a node are contiguous and sorted by lemma id.
+// A node that ends an n-gram holds the key it is stored under in phraseContexts.
+// Only n-grams with postings are added: a context kept just for the thesaurus
+// would otherwise be matched instead of a shorter n-gram that has postings.
+class NGramTrie {
+public:
+    void build(const unordered_map<uint64_t, WordContext*> &contexts,
+               const unordered_map<uint64_t, PostingList> &postings);
+
+    // Longest indexed n-gram that starts at lemmaIds[0], found in one walk.
+    // Returns its order and sets *key, 0 when even the first lemma is not indexed.
+    int longestMatch(const uint32_t *lemmaIds, int count, uint64_t *key) const;
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    size_t bytes() const {
+        return nodes.capacity() * sizeof(Node) + keys.capacity() * sizeof(uint64_t);
+    }
+
+private:
+    static const uint32_t NO_NGRAM = UINT32_MAX;
+
+    struct Node {
+        uint32_t lemmaId;
+        uint32_t firstChild;
+        uint32_t childCount;
+        // index in keys, NO_NGRAM for a prefix that is not indexed itself
+        uint32_t ngram;
+    };
+
+    vector<Node> nodes;
+    vector<uint64_t> keys;
+
+    const Node *child(const Node &node, uint32_t lemmaId) const;
+};
+
+#endif //LABS_NGRAMTRIE_H
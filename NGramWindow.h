@@ -0,0 +1,77 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_NGRAMWINDOW_H
+#define LABS_NGRAMWINDOW_H
+
+#include <vector>
+#include "dictionary.h"
+
+// Last Capacity words of a document in a fixed ring buffer, pushing a word is O(1).
+// Capacity 0 means the capacity is given at runtime, the buffer is then allocated once.
+template<int Capacity>
+class NGramWindow {
+public:
+    NGramWindow() = default;
+
+    explicit NGramWindow(int capacity) {
+        static_assert(Capacity == 0, "capacity is fixed at compile time");
+        dynamicWords.resize(capacity);
+    }
+
+    void push(Word *word) {
+        words()[head] = word;
+        head++;
+        if (head == capacity())
+            head = 0;
+        if (count < capacity())
+            count++;
+    }
+
+    // back(0) is the last pushed word, back(size() - 1) the oldest one
+    Word *back(int i) const {
+        int index = head - 1 - i;
+        if (index < 0)
+            index += capacity();
+        return words()[index];
+    }
+
+    int size() const {
+        return count;
+    }
+
+    int capacity() const {
+        if constexpr (Capacity == 0)
+            return (int) dynamicWords.size();
+        else
+            return Capacity;
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    Word *fixedWords[Capacity == 0 ? 1 : Capacity] = {};
+    vector<Word*> dynamicWords;
+    int head = 0;
+    int count = 0;
+
+    Word **words() {
+        if constexpr (Capacity == 0)
+            return dynamicWords.data();
+        else
+            return fixedWords;
+    }
+
+    Word *const *words() const {
+        if constexpr (Capacity == 0)
+            return dynamicWords.data();
+        else
+            return fixedWords;
+    }
+};
+
+#endif //LABS_NGRAMWINDOW_H
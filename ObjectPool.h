@@ -0,0 +1,61 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_OBJECTPOOL_H
+#define LABS_OBJECTPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Allocates objects in blocks of BlockSize and owns them: everything created by
+// the pool is destroyed with it, pointers stay valid until then.
+template<class T, size_t BlockSize = 4096>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    ~ObjectPool() {
+        clear();
+    }
+
+    template<class... Args>
+    T *create(Args &&... args) {
+        if (blocks.empty() || used == BlockSize) {
+            blocks.push_back(static_cast<T *>(::operator new(sizeof(T) * BlockSize)));
+            used = 0;
+        }
+
+        T *object = new(blocks.back() + used) T(std::forward<Args>(args)...);
+        used++;
+        count++;
+        return object;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    void clear() {
+        for (size_t block = 0; block < blocks.size(); block++) {
+            size_t blockUsed = block + 1 == blocks.size() ? used : BlockSize;
+            for (size_t i = 0; i < blockUsed; i++)
+                blocks[block][i].~T();
+            ::operator delete(blocks[block]);
+        }
+        blocks.clear();
+        used = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<T *> blocks;
+    size_t used = 0;
+    size_t count = 0;
+};
+
+#endif //LABS_OBJECTPOOL_H
@@ -0,0 +1,120 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "PostingCodec.h"
+
+#include <cstring>
+
+static const int LANES = 4;
+
+static int bitWidth(const uint32_t *values, size_t count) {
+    uint32_t all = 0;
+    for (size_t i = 0; i < count; i++)
+        all |= values[i];
+    int bits = 0;
+    while (bits < 32 && (all >> bits) != 0)
+        bits++;
+    return bits;
+}
+
+static void packBlock(const uint32_t *values, int bits, uint32_t *words) {
+    memset(words, 0, sizeof(uint32_t) * LANES * bits);
+    int word = 0, shift = 0;
+    for (size_t j = 0; j < PostingCodec::BLOCK_SIZE / LANES; j++) {
+        for (int lane = 0; lane < LANES; lane++) {
+            uint32_t value = values[j * LANES + lane];
+            words[word * LANES + lane] |= value << shift;
+            if (shift + bits > 32)
+                words[(word + 1) * LANES + lane] |= value >> (32 - shift);
+        }
+        shift += bits;
+        if (shift >= 32) {
+            shift -= 32;
+            word++;
+        }
+    }
+}
+
+static void unpackBlock(const uint32_t *words, int bits, uint32_t *values) {
+    if (bits == 0) {
+        memset(values, 0, sizeof(uint32_t) * PostingCodec::BLOCK_SIZE);
+        return;
+    }
+
+    uint32_t mask = bits == 32 ? UINT32_MAX : (1u << bits) - 1;
+    int word = 0, shift = 0;
+    for (size_t j = 0; j < PostingCodec::BLOCK_SIZE / LANES; j++) {
+        // the same word and shift for all lanes, the compiler vectorizes this loop
+        for (int lane = 0; lane < LANES; lane++) {
+            uint32_t value = words[word * LANES + lane] >> shift;
+            if (shift + bits > 32)
+                value |= words[(word + 1) * LANES + lane] << (32 - shift);
+            values[j * LANES + lane] = value & mask;
+        }
+        shift += bits;
+        if (shift >= 32) {
+            shift -= 32;
+            word++;
+        }
+    }
+}
+
+void PostingCodec::encode(const uint32_t *values, size_t count, vector<uint8_t> *out) {
+    size_t i = 0;
+    uint32_t words[LANES * 32];
+    for (; i + BLOCK_SIZE <= count; i += BLOCK_SIZE) {
+        int bits = bitWidth(values + i, BLOCK_SIZE);
+        packBlock(values + i, bits, words);
+        out->push_back((uint8_t) bits);
+        auto bytes = reinterpret_cast<const uint8_t *>(words);
+        out->insert(out->end(), bytes, bytes + sizeof(uint32_t) * LANES * bits);
+    }
+
+    for (; i < count; i++) {
+        uint32_t value = values[i];
+        while (value >= 0x80) {
+            out->push_back((uint8_t) (value | 0x80));
+            value >>= 7;
+        }
+        out->push_back((uint8_t) value);
+    }
+}
+
+const uint8_t *PostingCodec::decodeBlock(const uint8_t *in, size_t count, uint32_t *values) {
+    if (count == BLOCK_SIZE) {
+        int bits = *in++;
+        uint32_t words[LANES * 32];
+        memcpy(words, in, sizeof(uint32_t) * LANES * bits);
+        unpackBlock(words, bits, values);
+        return in + sizeof(uint32_t) * LANES * bits;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = 0;
+        int shift = 0;
+        while (*in & 0x80) {
+            value |= (uint32_t) (*in++ & 0x7f) << shift;
+            shift += 7;
+        }
+        values[i] = value | (uint32_t) *in++ << shift;
+    }
+    return in;
+}
+
+void PostingCodec::toGaps(uint32_t *values, size_t count, uint32_t first) {
+    uint32_t previous = first;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = values[i];
+        values[i] = value - previous;
+        previous = value;
+    }
+}
+
+void PostingCodec::fromGaps(uint32_t *values, size_t count, uint32_t first) {
+    uint32_t previous = first;
+    for (size_t i = 0; i < count; i++) {
+        previous += values[i];
+        values[i] = previous;
+    }
+}
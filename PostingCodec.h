@@ -0,0 +1,35 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_POSTINGCODEC_H
+#define LABS_POSTINGCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Integer sequences in blocks of 128 values bit-packed with the width of the largest
+// value of the block, and a variable-byte tail for the last < 128 values.
+// A packed block is a width byte followed by 4 interleaved lanes of 32-bit words:
+// value j goes to lane j % 4, so word k of all lanes is one 128-bit load and the
+// unpacking loop works on 4 values at a time.
+class PostingCodec {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    // Appends count values, full blocks first.
+    static void encode(const uint32_t *values, size_t count, vector<uint8_t> *out);
+
+    // Decodes one block of count values (BLOCK_SIZE unless it is the tail),
+    // returns the first byte after it.
+    static const uint8_t *decodeBlock(const uint8_t *in, size_t count, uint32_t *values);
+
+    // Gaps to values and back, first is the value before values[0].
+    static void toGaps(uint32_t *values, size_t count, uint32_t first);
+    static void fromGaps(uint32_t *values, size_t count, uint32_t first);
+};
+
+#endif //LABS_POSTINGCODEC_H
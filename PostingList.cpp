@@ -0,0 +1,251 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "PostingList.h"
+
+#include <algorithm>
+#include <cmath>
+
+PostingList::PostingList(const vector<pair<uint32_t, vector<int>>> &entries, bool asBitmap) {
+    documentCount = (uint32_t) entries.size();
+    if (asBitmap) {
+        vector<uint32_t> docIds;
+        for (const auto &entry : entries)
+            docIds.push_back(entry.first);
+        documentBitmap = make_unique<DocumentSet>(docIds.data(), docIds.size());
+    }
+
+    vector<uint32_t> positionGaps;
+    uint32_t docIds[BLOCK_SIZE], counts[BLOCK_SIZE];
+    uint32_t previousDocId = 0;
+    for (size_t begin = 0; begin < entries.size(); begin += BLOCK_SIZE) {
+        size_t count = min(BLOCK_SIZE, entries.size() - begin);
+        Block block{};
+        block.firstPosition = (uint32_t) positionGaps.size();
+
+        for (size_t i = 0; i < count; i++) {
+            const auto &entry = entries[begin + i];
+            docIds[i] = entry.first;
+            counts[i] = (uint32_t) entry.second.size();
+            uint32_t previousPosition = 0;
+            for (int position : entry.second) {
+                positionGaps.push_back((uint32_t) position - previousPosition);
+                previousPosition = (uint32_t) position;
+            }
+        }
+        block.lastDocId = docIds[count - 1];
+        PostingCodec::toGaps(docIds, count, previousDocId);
+        previousDocId = block.lastDocId;
+
+        block.docIdOffset = (uint32_t) data.size();
+        if (!asBitmap)
+            PostingCodec::encode(docIds, count, &data);
+        block.countOffset = (uint32_t) data.size();
+        PostingCodec::encode(counts, count, &data);
+        blocks.push_back(block);
+    }
+
+    positionCount = (uint32_t) positionGaps.size();
+    for (size_t begin = 0; begin < positionGaps.size(); begin += BLOCK_SIZE) {
+        positionBlocks.push_back((uint32_t) data.size());
+        PostingCodec::encode(&positionGaps[begin], min(BLOCK_SIZE, positionGaps.size() - begin), &data);
+    }
+
+    data.shrink_to_fit();
+    blocks.shrink_to_fit();
+    positionBlocks.shrink_to_fit();
+}
+
+size_t PostingList::decodeBlock(size_t block, uint32_t *docIds, uint32_t *counts) const {
+    size_t count = min(BLOCK_SIZE, (size_t) documentCount - block * BLOCK_SIZE);
+    if (documentBitmap) {
+        documentBitmap->collect(block == 0 ? 0 : blocks[block - 1].lastDocId + 1, count, docIds);
+    } else {
+        PostingCodec::decodeBlock(&data[blocks[block].docIdOffset], count, docIds);
+        PostingCodec::fromGaps(docIds, count, block == 0 ? 0 : blocks[block - 1].lastDocId);
+    }
+    PostingCodec::decodeBlock(&data[blocks[block].countOffset], count, counts);
+    return count;
+}
+
+void PostingList::decodePositions(size_t block, const uint32_t *counts, size_t documents,
+                                  vector<int> *positions) const {
+    size_t first = blocks[block].firstPosition;
+    size_t total = 0;
+    for (size_t i = 0; i < documents; i++)
+        total += counts[i];
+    positions->resize(total);
+
+    uint32_t values[BLOCK_SIZE];
+    size_t written = 0;
+    for (size_t positionBlock = first / BLOCK_SIZE; written < total; positionBlock++) {
+        size_t blockBegin = positionBlock * BLOCK_SIZE;
+        size_t blockCount = min(BLOCK_SIZE, (size_t) positionCount - blockBegin);
+        PostingCodec::decodeBlock(&data[positionBlocks[positionBlock]], blockCount, values);
+
+        size_t from = max(first, blockBegin) - blockBegin;
+        size_t to = min(blockCount, first + total - blockBegin);
+        for (size_t i = from; i < to; i++)
+            (*positions)[written++] = (int) values[i];
+    }
+
+    // gaps restart with every document
+    size_t offset = 0;
+    for (size_t i = 0; i < documents; i++) {
+        auto values = reinterpret_cast<uint32_t *>(positions->data() + offset);
+        PostingCodec::fromGaps(values, counts[i], 0);
+        offset += counts[i];
+    }
+}
+
+vector<pair<uint32_t, vector<int>>> PostingList::decode() const {
+    vector<pair<uint32_t, vector<int>>> entries;
+    entries.reserve(documentCount);
+
+    uint32_t docIds[BLOCK_SIZE], counts[BLOCK_SIZE];
+    vector<int> positions;
+    for (size_t block = 0; block < blocks.size(); block++) {
+        size_t count = decodeBlock(block, docIds, counts);
+        decodePositions(block, counts, count, &positions);
+
+        size_t offset = 0;
+        for (size_t i = 0; i < count; i++) {
+            entries.emplace_back(docIds[i], vector<int>(positions.begin() + offset,
+                                                        positions.begin() + offset + counts[i]));
+            offset += counts[i];
+        }
+    }
+    return entries;
+}
+
+vector<uint32_t> PostingList::documentIds() const {
+    if (documentBitmap)
+        return documentBitmap->toVector();
+    vector<uint32_t> docIds(documentCount);
+    uint32_t counts[BLOCK_SIZE];
+    for (size_t block = 0; block < blocks.size(); block++)
+        decodeBlock(block, &docIds[block * BLOCK_SIZE], counts);
+    return docIds;
+}
+
+DocumentSet intersectDocuments(const PostingList &a, const PostingList &b) {
+    if (a.bitmap() && b.bitmap())
+        return DocumentSet::intersect(*a.bitmap(), *b.bitmap());
+
+    vector<uint32_t> docIds;
+    if (a.bitmap() || b.bitmap()) {
+        // the list is decoded and probed in the bitmap
+        const DocumentSet &bitmap = a.bitmap() ? *a.bitmap() : *b.bitmap();
+        for (uint32_t docId : (a.bitmap() ? b : a).documentIds())
+            if (bitmap.contains(docId))
+                docIds.push_back(docId);
+    } else {
+        // the shorter list leads, the longer one skips blocks to its documents
+        PostingCursor leader(a.size() <= b.size() ? a : b);
+        PostingCursor follower(a.size() <= b.size() ? b : a);
+        for (; !leader.atEnd(); leader.next()) {
+            if (!follower.advance(leader.docId()))
+                break;
+            if (follower.docId() == leader.docId())
+                docIds.push_back(leader.docId());
+        }
+    }
+    return DocumentSet(docIds.data(), docIds.size());
+}
+
+DocumentSet uniteDocuments(const PostingList &a, const PostingList &b) {
+    if (a.bitmap() && b.bitmap())
+        return DocumentSet::unite(*a.bitmap(), *b.bitmap());
+
+    if (a.bitmap() || b.bitmap()) {
+        vector<uint32_t> docIds = (a.bitmap() ? b : a).documentIds();
+        return DocumentSet::unite(a.bitmap() ? *a.bitmap() : *b.bitmap(), DocumentSet(docIds.data(), docIds.size()));
+    }
+
+    vector<uint32_t> first = a.documentIds(), second = b.documentIds(), docIds;
+    set_union(first.begin(), first.end(), second.begin(), second.end(), back_inserter(docIds));
+    return DocumentSet(docIds.data(), docIds.size());
+}
+
+void PostingList::computeBlockMaxScores(const function<double(uint32_t, uint32_t)> &score) {
+    blockMaxScores.assign(blocks.size(), 0);
+    uint32_t docIds[BLOCK_SIZE], counts[BLOCK_SIZE];
+    for (size_t block = 0; block < blocks.size(); block++) {
+        size_t count = decodeBlock(block, docIds, counts);
+        double best = 0;
+        for (size_t i = 0; i < count; i++)
+            best = max(best, score(docIds[i], counts[i]));
+        // a bound must not drop below the exact score
+        auto rounded = (float) best;
+        blockMaxScores[block] = rounded < best ? nextafterf(rounded, INFINITY) : rounded;
+    }
+}
+
+size_t PostingList::findBlock(size_t from, uint32_t target) const {
+    auto found = gallop(blocks.begin() + from, blocks.end(), target,
+                        [](const Block &block, uint32_t docId) { return block.lastDocId < docId; });
+    return found - blocks.begin();
+}
+
+bool PostingList::find(uint32_t docId, uint32_t *count) const {
+    size_t block = findBlock(0, docId);
+    if (block == blocks.size())
+        return false;
+    uint32_t docIds[BLOCK_SIZE], counts[BLOCK_SIZE];
+    size_t size = decodeBlock(block, docIds, counts);
+    auto found = lower_bound(docIds, docIds + size, docId);
+    if (found == docIds + size || *found != docId)
+        return false;
+    *count = counts[found - docIds];
+    return true;
+}
+
+PostingCursor::PostingCursor(const PostingList &list) : list(&list) {
+    load(0);
+}
+
+void PostingCursor::load(size_t newBlock) {
+    block = newBlock;
+    index = 0;
+    if (!atEnd())
+        blockSize = list->decodeBlock(block, docIds, counts);
+}
+
+void PostingCursor::next() {
+    if (++index == blockSize)
+        load(block + 1);
+}
+
+bool PostingCursor::advance(uint32_t target) {
+    if (atEnd())
+        return false;
+    if (list->lastDocId(block) < target) {
+        load(list->findBlock(block + 1, target));
+        if (atEnd())
+            return false;
+    }
+    // the block holds a document >= target
+    index = gallop(docIds + index, docIds + blockSize, target, less<uint32_t>()) - docIds;
+    return true;
+}
+
+float PostingCursor::blockMaxScore(uint32_t target) const {
+    if (atEnd())
+        return 0;
+    size_t found = list->findBlock(block, target);
+    return found == list->blockCount() ? 0 : list->blockMaxScore(found);
+}
+
+const int *PostingCursor::positions() {
+    if (positionsBlock != block) {
+        list->decodePositions(block, counts, blockSize, &blockPositions);
+        uint32_t start = 0;
+        for (size_t i = 0; i < blockSize; i++) {
+            starts[i] = start;
+            start += counts[i];
+        }
+        positionsBlock = block;
+    }
+    return blockPositions.data() + starts[index];
+}
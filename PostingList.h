@@ -0,0 +1,179 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_POSTINGLIST_H
+#define LABS_POSTINGLIST_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "DocumentSet.h"
+#include "PostingCodec.h"
+
+using namespace std;
+
+// First element of [first, last) not less than value. Probes first + 1, 2, 4, ... and
+// halves the last step, so the cost grows with the distance from first, not the range.
+template<class It, class T, class Less>
+It gallop(It first, It last, const T &value, Less less) {
+    size_t size = last - first;
+    if (size == 0 || !less(*first, value))
+        return first;
+    size_t bound = 1;
+    while (bound < size && less(first[bound], value))
+        bound *= 2;
+    return lower_bound(first + bound / 2 + 1, first + min(bound, size), value, less);
+}
+
+// Compressed postings of one n-gram: document id gaps, position counts and position
+// gaps inside a document, each as a PostingCodec stream. Documents are decoded a block
+// of 128 at a time, the last document id of every block is kept for skipping.
+// The document ids of frequent n-grams are a DocumentSet instead of gaps. Every block
+// can also carry the largest score of its documents for top-k pruning.
+class PostingList {
+public:
+    static constexpr size_t BLOCK_SIZE = PostingCodec::BLOCK_SIZE;
+
+    PostingList() = default;
+    PostingList(const vector<pair<uint32_t, vector<int>>> &entries, bool asBitmap);
+
+    // nullptr when the document ids are a compressed list
+    const DocumentSet *bitmap() const {
+        return documentBitmap.get();
+    }
+
+    vector<uint32_t> documentIds() const;
+
+    size_t size() const {
+        return documentCount;
+    }
+
+    size_t blockCount() const {
+        return blocks.size();
+    }
+
+    uint32_t lastDocId(size_t block) const {
+        return blocks[block].lastDocId;
+    }
+
+    // Largest score(docId, count) of every block, rounded up to float. Kept apart from
+    // the blocks so that skipping by score reads only this small array.
+    void computeBlockMaxScores(const function<double(uint32_t, uint32_t)> &score);
+
+    // 0 before computeBlockMaxScores
+    float blockMaxScore(size_t block) const {
+        return blockMaxScores.empty() ? 0 : blockMaxScores[block];
+    }
+
+    float maxScore() const {
+        return blockMaxScores.empty() ? 0 : *max_element(blockMaxScores.begin(), blockMaxScores.end());
+    }
+
+    // First block that can hold target, from the block from on, blockCount() if none.
+    size_t findBlock(size_t from, uint32_t target) const;
+
+    // Whether the document has an entry, with its position count.
+    bool find(uint32_t docId, uint32_t *count) const;
+
+    // Document ids and position counts of a block, returns the number of documents.
+    size_t decodeBlock(size_t block, uint32_t *docIds, uint32_t *counts) const;
+
+    // Positions of all documents of a block in document order, counts are the
+    // ones decodeBlock returned.
+    void decodePositions(size_t block, const uint32_t *counts, size_t documents, vector<int> *positions) const;
+
+    // Everything back as (document id, positions) pairs.
+    vector<pair<uint32_t, vector<int>>> decode() const;
+
+    size_t bytes() const {
+        return sizeof(PostingList) + data.capacity() + blocks.capacity() * sizeof(Block) +
+               positionBlocks.capacity() * sizeof(uint32_t) + blockMaxScores.capacity() * sizeof(float) +
+               (documentBitmap ? documentBitmap->bytes() : 0);
+    }
+
+private:
+    struct Block {
+        uint32_t lastDocId;
+        // offsets of the block in data, there are no id gaps with a bitmap
+        uint32_t docIdOffset;
+        uint32_t countOffset;
+        // index of the first position of the block in the position stream
+        uint32_t firstPosition;
+    };
+
+    uint32_t documentCount = 0;
+    uint32_t positionCount = 0;
+    unique_ptr<DocumentSet> documentBitmap;
+    // document blocks, then the position stream
+    vector<uint8_t> data;
+    vector<Block> blocks;
+    // offset of every block of the position stream in data
+    vector<uint32_t> positionBlocks;
+    vector<float> blockMaxScores;
+};
+
+// Documents of both lists, or of either of them, with a separate way for every pair
+// of bitmap and list postings.
+DocumentSet intersectDocuments(const PostingList &a, const PostingList &b);
+DocumentSet uniteDocuments(const PostingList &a, const PostingList &b);
+
+// Walks a PostingList in document id order one block at a time. advance gallops over
+// whole blocks by their last document id, then inside the decoded block.
+class PostingCursor {
+public:
+    explicit PostingCursor(const PostingList &list);
+
+    bool atEnd() const {
+        return block == list->blockCount();
+    }
+
+    uint32_t docId() const {
+        return docIds[index];
+    }
+
+    // positions of the n-gram in the current document
+    uint32_t count() const {
+        return counts[index];
+    }
+
+    void next();
+
+    // Moves to the first document >= target, false if there is none.
+    bool advance(uint32_t target);
+
+    // Largest score in the current block and the last document it covers.
+    float blockMaxScore() const {
+        return list->blockMaxScore(block);
+    }
+
+    uint32_t blockLastDocId() const {
+        return list->lastDocId(block);
+    }
+
+    // Largest score of the block that may hold target without decoding it, 0 when no
+    // block from the current one on does. The cursor does not move.
+    float blockMaxScore(uint32_t target) const;
+
+    // Positions in the current document, the block's positions are decoded on first use.
+    const int *positions();
+
+private:
+    const PostingList *list;
+    size_t block = 0;
+    size_t blockSize = 0;
+    size_t index = 0;
+    uint32_t docIds[PostingList::BLOCK_SIZE];
+    uint32_t counts[PostingList::BLOCK_SIZE];
+    // positions of the whole block and where every document starts in them
+    size_t positionsBlock = SIZE_MAX;
+    vector<int> blockPositions;
+    uint32_t starts[PostingList::BLOCK_SIZE];
+
+    void load(size_t newBlock);
+};
+
+#endif //LABS_POSTINGLIST_H
@@ -0,0 +1,70 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_RADIXSORT_H
+#define LABS_RADIXSORT_H
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Runs body(0..threads-1), the calling thread takes part 0.
+template<class Body>
+void runParallel(int threads, Body body) {
+    vector<thread> helpers;
+    for (int part = 1; part < threads; part++)
+        helpers.emplace_back(body, part);
+    body(0);
+    for (auto &helper : helpers)
+        helper.join();
+}
+
+// Stable LSD radix sort of items by a 64-bit key, 16 bits per pass. Every thread counts
+// and scatters its own slice, so items of one key keep their input order.
+// buffer is scratch space of the same size.
+template<class T, class Key>
+void radixSort(vector<T> *items, vector<T> *buffer, int threads, Key key) {
+    const int DIGIT_BITS = 16;
+    const size_t BUCKETS = (size_t) 1 << DIGIT_BITS;
+    const size_t MIN_SLICE = 1 << 16;
+
+    size_t count = items->size();
+    buffer->resize(count);
+    threads = (int) max((size_t) 1, min((size_t) threads, count / MIN_SLICE));
+    vector<vector<size_t>> offsets(threads, vector<size_t>(BUCKETS));
+
+    for (int shift = 0; shift < 64; shift += DIGIT_BITS) {
+        auto digit = [&](const T &item) {
+            return (size_t) (key(item) >> shift) & (BUCKETS - 1);
+        };
+
+        runParallel(threads, [&](int part) {
+            auto &counts = offsets[part];
+            fill(counts.begin(), counts.end(), 0);
+            for (size_t i = count * part / threads; i < count * (part + 1) / threads; i++)
+                counts[digit((*items)[i])]++;
+        });
+
+        // bucket by bucket, slices in order inside a bucket
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+            for (int part = 0; part < threads; part++) {
+                size_t bucketCount = offsets[part][bucket];
+                offsets[part][bucket] = offset;
+                offset += bucketCount;
+            }
+        }
+
+        runParallel(threads, [&](int part) {
+            auto &next = offsets[part];
+            for (size_t i = count * part / threads; i < count * (part + 1) / threads; i++)
+                (*buffer)[next[digit((*items)[i])]++] = (*items)[i];
+        });
+        items->swap(*buffer);
+    }
+}
+
+#endif //LABS_RADIXSORT_H
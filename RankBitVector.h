@@ -0,0 +1,62 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_RANKBITVECTOR_H
+#define LABS_RANKBITVECTOR_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Bits with counts of ones before every 512-bit block, so rank is one table read and
+// at most 8 popcounts, for 1/16 of the bits on top.
+class RankBitVector {
+public:
+    explicit RankBitVector(size_t size = 0) : words(size / 64 + 1, 0) {
+    }
+
+    void set(size_t i) {
+        words[i / 64] |= (uint64_t) 1 << (i % 64);
+    }
+
+    bool get(size_t i) const {
+        return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    // after the last set()
+    void buildRanks() {
+        blockRanks.assign(words.size() / 8 + 1, 0);
+        uint32_t ones = 0;
+        for (size_t word = 0; word < words.size(); word++) {
+            if (word % 8 == 0)
+                blockRanks[word / 8] = ones;
+            ones += (uint32_t) __builtin_popcountll(words[word]);
+        }
+    }
+
+    // ones in [0, i)
+    size_t rank1(size_t i) const {
+        size_t ones = blockRanks[i / 512];
+        for (size_t word = i / 512 * 8; word < i / 64; word++)
+            ones += __builtin_popcountll(words[word]);
+        if (i % 64)
+            ones += __builtin_popcountll(words[i / 64] & (((uint64_t) 1 << (i % 64)) - 1));
+        return ones;
+    }
+
+    size_t rank0(size_t i) const {
+        return i - rank1(i);
+    }
+
+    size_t bytes() const {
+        return words.capacity() * sizeof(uint64_t) + blockRanks.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    vector<uint64_t> words;
+    vector<uint32_t> blockRanks;
+};
+
+#endif //LABS_RANKBITVECTOR_H
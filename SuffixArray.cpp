@@ -0,0 +1,226 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "SuffixArray.h"
+#include "RadixSort.h"
+
+#include <algorithm>
+
+// Start (or end, one past the last slot) of the bucket of every symbol 0..maxSymbol.
+static void bucketBounds(const int32_t *s, size_t n, int32_t maxSymbol, bool ends, vector<int32_t> *bounds) {
+    bounds->assign(maxSymbol + 1, 0);
+    for (size_t i = 0; i < n; i++)
+        (*bounds)[s[i]]++;
+    int32_t sum = 0;
+    for (auto &bound : *bounds) {
+        sum += bound;
+        bound = ends ? sum : sum - bound;
+    }
+}
+
+// L-type suffixes from the sorted ones in SA left to right, then S-type right to left.
+static void induce(const int32_t *s, int32_t *sa, size_t n, int32_t maxSymbol, const vector<bool> &sType,
+                   vector<int32_t> *bounds) {
+    bucketBounds(s, n, maxSymbol, false, bounds);
+    for (size_t i = 0; i < n; i++) {
+        int32_t j = sa[i] - 1;
+        if (sa[i] > 0 && !sType[j])
+            sa[(*bounds)[s[j]]++] = j;
+    }
+    bucketBounds(s, n, maxSymbol, true, bounds);
+    for (size_t i = n; i > 0; i--) {
+        int32_t j = sa[i - 1] - 1;
+        if (sa[i - 1] > 0 && sType[j])
+            sa[--(*bounds)[s[j]]] = j;
+    }
+}
+
+// SA-IS (Nong, Zhang, Chan): sorts the LMS substrings by induction, names them, sorts the
+// reduced string recursively and induces the full order from it. s[n - 1] must be the only 0.
+static void sais(const int32_t *s, int32_t *sa, size_t n, int32_t maxSymbol) {
+    // an empty corpus is the 0 alone, which has no LMS suffix
+    if (n == 1) {
+        sa[0] = 0;
+        return;
+    }
+    vector<bool> sType(n, false);
+    sType[n - 1] = true;
+    for (size_t i = n - 1; i > 0; i--)
+        sType[i - 1] = s[i - 1] < s[i] || (s[i - 1] == s[i] && sType[i]);
+    auto isLms = [&](size_t i) {
+        return i > 0 && sType[i] && !sType[i - 1];
+    };
+
+    vector<int32_t> bounds;
+    bucketBounds(s, n, maxSymbol, true, &bounds);
+    fill(sa, sa + n, -1);
+    for (size_t i = 1; i < n; i++)
+        if (isLms(i))
+            sa[--bounds[s[i]]] = (int32_t) i;
+    induce(s, sa, n, maxSymbol, sType, &bounds);
+
+    // sorted LMS substrings to the front, then their names into the back half
+    size_t lmsCount = 0;
+    for (size_t i = 0; i < n; i++)
+        if (isLms(sa[i]))
+            sa[lmsCount++] = sa[i];
+    fill(sa + lmsCount, sa + n, -1);
+    int32_t names = 0;
+    int32_t previous = -1;
+    for (size_t i = 0; i < lmsCount; i++) {
+        int32_t position = sa[i];
+        bool differs = false;
+        for (size_t d = 0; d < n; d++) {
+            if (previous == -1 || s[position + d] != s[previous + d] ||
+                sType[position + d] != sType[previous + d]) {
+                differs = true;
+                break;
+            }
+            if (d > 0 && (isLms(position + d) || isLms(previous + d)))
+                break;
+        }
+        if (differs) {
+            names++;
+            previous = position;
+        }
+        // LMS positions are at least two apart
+        sa[lmsCount + position / 2] = names - 1;
+    }
+    for (size_t i = n, j = n; i > lmsCount; i--)
+        if (sa[i - 1] >= 0)
+            sa[--j] = sa[i - 1];
+
+    // the reduced string is the last lmsCount slots, its suffix array the first ones
+    int32_t *reduced = sa + n - lmsCount;
+    if ((size_t) names < lmsCount) {
+        sais(reduced, sa, lmsCount, names - 1);
+    } else {
+        for (size_t i = 0; i < lmsCount; i++)
+            sa[reduced[i]] = (int32_t) i;
+    }
+
+    // LMS suffixes in their final order to the ends of their buckets
+    for (size_t i = 1, j = 0; i < n; i++)
+        if (isLms(i))
+            reduced[j++] = (int32_t) i;
+    for (size_t i = 0; i < lmsCount; i++)
+        sa[i] = reduced[sa[i]];
+    fill(sa + lmsCount, sa + n, -1);
+    bucketBounds(s, n, maxSymbol, true, &bounds);
+    for (size_t i = lmsCount; i > 0; i--) {
+        int32_t j = sa[i - 1];
+        sa[i - 1] = -1;
+        sa[--bounds[s[j]]] = j;
+    }
+    induce(s, sa, n, maxSymbol, sType, &bounds);
+}
+
+void SuffixArray::build(const vector<uint32_t> &lemmaIds, const vector<uint32_t> &documentStarts, int threads) {
+    text.clear();
+    starts.clear();
+    text.reserve(lemmaIds.size() + documentStarts.size() + 1);
+    int32_t maxSymbol = 1;
+    for (size_t doc = 0; doc < documentStarts.size(); doc++) {
+        starts.push_back((uint32_t) text.size());
+        size_t end = doc + 1 < documentStarts.size() ? documentStarts[doc + 1] : lemmaIds.size();
+        for (size_t i = documentStarts[doc]; i < end; i++) {
+            text.push_back((int32_t) lemmaIds[i] + 2);
+            maxSymbol = max(maxSymbol, text.back());
+        }
+        text.push_back(1);
+    }
+    text.push_back(0);
+
+    size_t n = text.size();
+    suffixes.resize(n);
+    sais(text.data(), suffixes.data(), n, maxSymbol);
+
+    // Kasai: the common prefix of a suffix and its neighbour above in the array shrinks by
+    // at most one from text position i to i + 1. Every slice of text starts from 0 and is
+    // filled by its own thread.
+    vector<uint32_t> rank(n);
+    threads = (int) max((size_t) 1, min((size_t) threads, n / (1 << 16)));
+    runParallel(threads, [&](int part) {
+        for (size_t i = n * part / threads; i < n * (part + 1) / threads; i++)
+            rank[suffixes[i]] = (uint32_t) i;
+    });
+    lcp.assign(n, 0);
+    runParallel(threads, [&](int part) {
+        uint32_t common = 0;
+        for (size_t i = n * part / threads; i < n * (part + 1) / threads; i++) {
+            if (rank[i] == 0) {
+                common = 0;
+                continue;
+            }
+            size_t above = suffixes[rank[i] - 1];
+            while (i + common < n && above + common < n && text[i + common] == text[above + common] &&
+                   text[i + common] > 1)
+                common++;
+            lcp[rank[i]] = common;
+            if (common > 0)
+                common--;
+        }
+    });
+}
+
+pair<size_t, size_t> SuffixArray::find(const uint32_t *lemmaIds, size_t count) const {
+    // -1 when the suffix is smaller than the pattern, 1 when it starts with it
+    auto compare = [&](int32_t suffix) {
+        for (size_t i = 0; i < count; i++) {
+            int32_t symbol = (int32_t) lemmaIds[i] + 2;
+            if (text[suffix + i] != symbol)
+                return text[suffix + i] < symbol ? -1 : 2;
+        }
+        return 1;
+    };
+    size_t begin = partition_point(suffixes.begin(), suffixes.end(),
+                                   [&](int32_t suffix) { return compare(suffix) < 0; }) - suffixes.begin();
+    size_t end = partition_point(suffixes.begin() + begin, suffixes.end(),
+                                 [&](int32_t suffix) { return compare(suffix) == 1; }) - suffixes.begin();
+    return {begin, end};
+}
+
+vector<pair<uint32_t, uint32_t>> SuffixArray::occurrences(const uint32_t *lemmaIds, size_t count,
+                                                          const DocumentTable &documents) const {
+    auto range = find(lemmaIds, count);
+    vector<uint32_t> positions;
+    for (size_t i = range.first; i < range.second; i++)
+        positions.push_back((uint32_t) suffixes[i]);
+    return countByDocument(positions, (uint32_t) count, starts, documents);
+}
+
+vector<pair<uint32_t, uint32_t>> SuffixArray::countByDocument(const vector<uint32_t> &positions, uint32_t count,
+                                                              const vector<uint32_t> &starts,
+                                                              const DocumentTable &documents) {
+    vector<pair<uint32_t, uint32_t>> found;
+    for (uint32_t position : positions) {
+        uint32_t docId = (uint32_t) (upper_bound(starts.begin(), starts.end(), position) - starts.begin()) - 1;
+        uint32_t first = position - starts[docId];
+        // the n-gram index does not count sequences that run across a sentence end
+        if (documents.sameSentence(docId, first, first + count - 1))
+            found.emplace_back(docId, first);
+    }
+    sort(found.begin(), found.end());
+
+    vector<pair<uint32_t, uint32_t>> counts;
+    for (const auto &occurrence : found) {
+        if (counts.empty() || counts.back().first != occurrence.first)
+            counts.emplace_back(occurrence.first, 0);
+        counts.back().second++;
+    }
+    return counts;
+}
+
+size_t SuffixArray::repeatedSequences(uint32_t length) const {
+    // every run of neighbours sharing length tokens is one sequence
+    size_t sequences = 0;
+    for (size_t i = 1; i < lcp.size(); i++)
+        if (lcp[i] >= length && lcp[i - 1] < length)
+            sequences++;
+    return sequences;
+}
+
+uint32_t SuffixArray::longestRepeat() const {
+    return lcp.empty() ? 0 : *max_element(lcp.begin(), lcp.end());
+}
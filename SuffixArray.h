@@ -0,0 +1,73 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_SUFFIXARRAY_H
+#define LABS_SUFFIXARRAY_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "DocumentTable.h"
+
+using namespace std;
+
+// Suffix array and LCP array of the lemma id stream of the whole corpus, documents
+// separated by a symbol no lemma has. Finds every occurrence of a token sequence of
+// any length in O(m log n), n-gram orders play no role here.
+class SuffixArray {
+public:
+    // documentStarts has the index of the first token of every document in lemmaIds.
+    // SA-IS builds the array in linear time, the LCP array is split between threads.
+    void build(const vector<uint32_t> &lemmaIds, const vector<uint32_t> &documentStarts, int threads);
+
+    // Suffixes that start with lemmaIds, as a range of the array.
+    pair<size_t, size_t> find(const uint32_t *lemmaIds, size_t count) const;
+
+    // Documents that contain lemmaIds inside one sentence, with the number of
+    // occurrences, in document id order.
+    vector<pair<uint32_t, uint32_t>> occurrences(const uint32_t *lemmaIds, size_t count,
+                                                 const DocumentTable &documents) const;
+
+    // Text positions of a sequence of count tokens grouped by document as occurrences()
+    // returns them. starts are the document starts in text.
+    static vector<pair<uint32_t, uint32_t>> countByDocument(const vector<uint32_t> &positions, uint32_t count,
+                                                            const vector<uint32_t> &starts,
+                                                            const DocumentTable &documents);
+
+    // Distinct token sequences of length tokens that occur at least twice.
+    size_t repeatedSequences(uint32_t length) const;
+
+    uint32_t longestRepeat() const;
+
+    size_t size() const {
+        return suffixes.size();
+    }
+
+    int32_t symbol(size_t position) const {
+        return text[position];
+    }
+
+    uint32_t suffix(size_t rank) const {
+        return (uint32_t) suffixes[rank];
+    }
+
+    const vector<uint32_t> &documentStarts() const {
+        return starts;
+    }
+
+    size_t bytes() const {
+        return (text.capacity() + suffixes.capacity() + lcp.capacity() + starts.capacity()) * sizeof(uint32_t);
+    }
+
+private:
+    // lemma id + 2 for every token, 1 after every document and 0 at the very end
+    vector<int32_t> text;
+    vector<int32_t> suffixes;
+    // lcp[i] is the common prefix of suffixes i - 1 and i, separators never match
+    vector<uint32_t> lcp;
+    // where every document starts in text
+    vector<uint32_t> starts;
+};
+
+#endif //LABS_SUFFIXARRAY_H
@@ -0,0 +1,90 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_WAVELETMATRIX_H
+#define LABS_WAVELETMATRIX_H
+
+#include <cstdint>
+#include <vector>
+#include "RankBitVector.h"
+
+using namespace std;
+
+// Sequence of symbols in one bit vector per bit of the largest symbol, highest bit first.
+// Every level is stably split into its 0s and then its 1s for the next one, so access
+// and rank follow a symbol with one bit-vector rank per level.
+class WaveletMatrix {
+public:
+    void build(vector<uint32_t> symbols, uint32_t maxSymbol) {
+        count = symbols.size();
+        levels.clear();
+        zeros.clear();
+        int bits = 1;
+        while (bits < 32 && (maxSymbol >> bits) != 0)
+            bits++;
+
+        vector<uint32_t> next(count);
+        for (int level = 0; level < bits; level++) {
+            int shift = bits - 1 - level;
+            levels.emplace_back(count);
+            size_t zeroCount = 0;
+            for (size_t i = 0; i < count; i++) {
+                if ((symbols[i] >> shift) & 1)
+                    levels.back().set(i);
+                else
+                    next[zeroCount++] = symbols[i];
+            }
+            levels.back().buildRanks();
+            zeros.push_back(zeroCount);
+            for (size_t i = 0, ones = zeroCount; i < count; i++)
+                if ((symbols[i] >> shift) & 1)
+                    next[ones++] = symbols[i];
+            symbols.swap(next);
+        }
+    }
+
+    uint32_t access(size_t i) const {
+        uint32_t symbol = 0;
+        for (size_t level = 0; level < levels.size(); level++) {
+            bool bit = levels[level].get(i);
+            symbol = symbol << 1 | bit;
+            i = bit ? zeros[level] + levels[level].rank1(i) : levels[level].rank0(i);
+        }
+        return symbol;
+    }
+
+    // occurrences of symbol in [0, i)
+    size_t rank(uint32_t symbol, size_t i) const {
+        size_t begin = 0;
+        for (size_t level = 0; level < levels.size(); level++) {
+            if ((symbol >> (levels.size() - 1 - level)) & 1) {
+                i = zeros[level] + levels[level].rank1(i);
+                begin = zeros[level] + levels[level].rank1(begin);
+            } else {
+                i = levels[level].rank0(i);
+                begin = levels[level].rank0(begin);
+            }
+        }
+        return i - begin;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t bytes() const {
+        size_t total = zeros.capacity() * sizeof(size_t);
+        for (const auto &level : levels)
+            total += sizeof(RankBitVector) + level.bytes();
+        return total;
+    }
+
+private:
+    size_t count = 0;
+    vector<RankBitVector> levels;
+    // zeros of every level, where its 1s start on the next one
+    vector<size_t> zeros;
+};
+
+#endif //LABS_WAVELETMATRIX_H
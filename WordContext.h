@@ -5,17 +5,21 @@
 #ifndef LABS_WORDCONTEXT_H
 #define LABS_WORDCONTEXT_H
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 #include "dictionary.h"
 class WordContext {
 public:
-    wstring normalizedForm;
+    vector<uint32_t> lemmas;
     double stability = 0;
-    unordered_map <string, vector<int>> textEntries;
+    // positions per document, documents are indexed in id order so the list is sorted
+    vector<pair<uint32_t, vector<int>>> textEntries;
 
-    WordContext(const wstring& normalizedForm) {
-        this->normalizedForm = normalizedForm;
+    vector<int> &entriesIn(uint32_t docId) {
+        if (textEntries.empty() || textEntries.back().first != docId)
+            textEntries.emplace_back(docId, vector<int>{});
+        return textEntries.back().second;
     }
 };
 #endif //LABS_WORDCONTEXT_H
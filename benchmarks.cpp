@@ -0,0 +1,986 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "benchmarks.h"
+#include "dictionary.h"
+#include "NGramWindow.h"
+#include "NGramKey.h"
+#include "indexer.h"
+#include "ConcurrentNGramMap.h"
+#include "search.h"
+#include "textreader.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <sys/resource.h>
+
+#ifdef TEXTREADER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+double peakMemoryMb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1048576.0;
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+static vector<Word*> randomTokens(vector<Word> &pool, size_t count) {
+    mt19937 random(42);
+    vector<Word*> tokens;
+    tokens.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        tokens.push_back(&pool[random() % pool.size()]);
+    return tokens;
+}
+
+// The window as handleWord kept it before: one pass per order, erase(begin())
+// to slide and a copy of the window for every n-gram.
+static uint64_t runVectorWindow(const vector<Word*> &tokens, int maxOrder) {
+    uint64_t checksum = 0;
+    for (size_t order = 1; order <= (size_t) maxOrder; order++) {
+        vector<Word*> leftWordContext;
+        for (Word *word : tokens) {
+            if (order <= leftWordContext.size()) {
+                vector<Word*> contextVector;
+                for (size_t i = 0; i < order; i++)
+                    contextVector.push_back(leftWordContext[i]);
+                checksum += (uintptr_t) contextVector.back();
+            }
+            if (leftWordContext.size() == order + 1)
+                leftWordContext.erase(leftWordContext.begin());
+            leftWordContext.push_back(word);
+        }
+    }
+    return checksum;
+}
+
+template<int MaxOrder>
+static uint64_t runRingWindow(const vector<Word*> &tokens, NGramWindow<MaxOrder> window) {
+    uint64_t checksum = 0;
+    for (Word *word : tokens) {
+        window.push(word);
+        for (int order = 1; order <= window.size(); order++)
+            checksum += (uintptr_t) window.back(order - 1);
+    }
+    return checksum;
+}
+
+template<class Run>
+static double nanosPerToken(size_t tokenCount, Run run, uint64_t *checksum) {
+    auto begin = chrono::steady_clock::now();
+    *checksum += run();
+    auto end = chrono::steady_clock::now();
+    return (double) chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / tokenCount;
+}
+
+void benchmarkWindow() {
+    vector<Word> pool(1000);
+    const size_t tokenCount = 5000000;
+    vector<Word*> tokens = randomTokens(pool, tokenCount);
+    uint64_t checksum = 0;
+
+    cout << "order | vector window, ns/token | ring window, ns/token" << endl;
+    for (int order = 1; order <= 5; order++) {
+        double vectorCost = nanosPerToken(tokenCount, [&] { return runVectorWindow(tokens, order); }, &checksum);
+        double ringCost;
+        switch (order) {
+            case 1:
+                ringCost = nanosPerToken(tokenCount, [&] { return runRingWindow(tokens, NGramWindow<1>()); }, &checksum);
+                break;
+            case 2:
+                ringCost = nanosPerToken(tokenCount, [&] { return runRingWindow(tokens, NGramWindow<2>()); }, &checksum);
+                break;
+            case 3:
+                ringCost = nanosPerToken(tokenCount, [&] { return runRingWindow(tokens, NGramWindow<3>()); }, &checksum);
+                break;
+            default:
+                ringCost = nanosPerToken(tokenCount, [&] { return runRingWindow(tokens, NGramWindow<0>(order)); }, &checksum);
+        }
+        cout << order << " | " << vectorCost << " | " << ringCost << endl;
+    }
+    cout << "checksum " << checksum << endl;
+}
+
+// Order independent over n-grams, order dependent inside a posting list.
+static uint64_t indexFingerprint(const NGramIndex &index) {
+    uint64_t fingerprint = 0;
+    for (const auto &pairPostings : index.postings) {
+        uint64_t hash = ngramKey(index.phraseContexts.at(pairPostings.first)->lemmas);
+        for (const auto &entry : pairPostings.second.decode()) {
+            hash = mixKey(hash ^ entry.first);
+            for (int position : entry.second)
+                hash = mixKey(hash ^ (uint64_t) position);
+        }
+        fingerprint += hash;
+    }
+    return fingerprint;
+}
+
+static double buildSeconds(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                           const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                           const IndexSettings &settings, uint64_t *fingerprint) {
+    auto begin = chrono::steady_clock::now();
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, settings, &index);
+    auto end = chrono::steady_clock::now();
+    *fingerprint = indexFingerprint(index);
+    return chrono::duration_cast<chrono::milliseconds>(end - begin).count() / 1000.0;
+}
+
+void benchmarkBuild(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                    const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                    const IndexSettings &settings) {
+    int cores = max(1, (int) thread::hardware_concurrency());
+    vector<int> threadCounts{1};
+    for (int threads = 2; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    if (cores > 1)
+        threadCounts.push_back(cores);
+
+    const vector<pair<IndexBuildMode, string>> modes{
+            {PARTIAL_INDEXES, "partial indexes"}, {SHARED_MAP, "shared map"}, {SORT_BASED, "sort-based"}};
+    uint64_t expected = 0;
+    double sequentialSeconds = 0;
+    vector<vector<double>> timings;
+    for (int threads : threadCounts) {
+        IndexSettings threadSettings = settings;
+        threadSettings.threads = threads;
+
+        timings.emplace_back();
+        for (const auto &mode : modes) {
+            threadSettings.buildMode = mode.first;
+            uint64_t fingerprint;
+            double seconds = buildSeconds(files, dictionary, relations, threadSettings, &fingerprint);
+            timings.back().push_back(seconds);
+
+            if (threads == 1 && mode.first == PARTIAL_INDEXES) {
+                expected = fingerprint;
+                sequentialSeconds = seconds;
+            } else if (fingerprint != expected) {
+                cout << "Index built with " << threads << " threads, " << mode.second
+                     << ", differs from the sequential one" << endl;
+            }
+        }
+    }
+
+    if (cores == 1)
+        cout << "One core: every build runs on it, the speedup is not measured" << endl;
+    cout << "threads";
+    for (const auto &mode : modes)
+        cout << " | " << mode.second << ", s | speedup";
+    cout << endl;
+    for (size_t i = 0; i < threadCounts.size(); i++) {
+        cout << threadCounts[i];
+        for (double seconds : timings[i])
+            cout << " | " << seconds << " | " << sequentialSeconds / seconds;
+        cout << endl;
+    }
+}
+
+// Documents of a Zipf-distributed vocabulary: a few keys take most of the occurrences,
+// as the function words and punctuation do in the corpus.
+static vector<vector<uint32_t>> zipfDocuments(size_t documentCount, size_t documentLength, uint32_t vocabulary) {
+    vector<double> weights(vocabulary);
+    for (uint32_t rank = 0; rank < vocabulary; rank++)
+        weights[rank] = 1.0 / (rank + 1);
+    discrete_distribution<uint32_t> zipf(weights.begin(), weights.end());
+
+    mt19937 random(42);
+    vector<vector<uint32_t>> documents(documentCount);
+    for (auto &document : documents) {
+        document.resize(documentLength);
+        for (auto &lemmaId : document)
+            lemmaId = zipf(random);
+    }
+    return documents;
+}
+
+template<class IndexDocument>
+static double millionsPerSecond(const vector<vector<uint32_t>> &documents, int threads,
+                                IndexDocument indexDocument) {
+    auto begin = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int worker = 0; worker < threads; worker++) {
+        workers.emplace_back([&, worker] {
+            for (size_t docId = worker; docId < documents.size(); docId += threads)
+                indexDocument(worker, (uint32_t) docId, documents[docId]);
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    auto end = chrono::steady_clock::now();
+
+    size_t occurrences = documents.size() * documents[0].size();
+    return occurrences / (double) chrono::duration_cast<chrono::microseconds>(end - begin).count();
+}
+
+void benchmarkConcurrentMap() {
+    vector<vector<uint32_t>> documents = zipfDocuments(2000, 2000, 50000);
+
+    cout << "threads | mutex + unordered_map, Mops/s | ConcurrentNGramMap, Mops/s" << endl;
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        vector<unique_ptr<ObjectPool<WordContext>>> pools;
+        for (int worker = 0; worker < threads; worker++)
+            pools.push_back(make_unique<ObjectPool<WordContext>>());
+
+        // one lock around the map, every occurrence is appended under it
+        mutex globalLock;
+        unordered_map<uint64_t, WordContext*> lockedContexts;
+        double lockedSpeed = millionsPerSecond(documents, threads, [&](int worker, uint32_t docId,
+                                                                      const vector<uint32_t> &document) {
+            for (size_t position = 0; position < document.size(); position++) {
+                uint64_t key = prependLemma(0, document[position]);
+                lock_guard<mutex> lock(globalLock);
+                findContext(&lockedContexts, &key, 1, [&](int) { return document[position]; },
+                            pools[worker].get())->entriesIn(docId).push_back((int) position);
+            }
+        });
+
+        // the same work as the SHARED_MAP build: cached lookups and one append per n-gram and document
+        ConcurrentNGramMap sharedContexts;
+        vector<unique_ptr<ConcurrentNGramMap::LocalCache>> caches;
+        for (int worker = 0; worker < threads; worker++)
+            caches.push_back(make_unique<ConcurrentNGramMap::LocalCache>());
+        double sharedSpeed = millionsPerSecond(documents, threads, [&](int worker, uint32_t docId,
+                                                                      const vector<uint32_t> &document) {
+            vector<pair<WordContext*, int>> occurrences;
+            for (size_t position = 0; position < document.size(); position++) {
+                uint64_t key = prependLemma(0, document[position]);
+                WordContext *context = sharedContexts.findOrAdd(key, 1, [&](int) { return document[position]; },
+                                                                pools[worker].get(), caches[worker].get());
+                occurrences.emplace_back(context, (int) position);
+            }
+            sort(occurrences.begin(), occurrences.end());
+            for (size_t begin = 0; begin < occurrences.size();) {
+                size_t end = begin;
+                vector<int> positions;
+                for (; end < occurrences.size() && occurrences[end].first == occurrences[begin].first; end++)
+                    positions.push_back(occurrences[end].second);
+                WordContext *context = occurrences[begin].first;
+                sharedContexts.append(ngramKey(context->lemmas), [&] {
+                    context->textEntries.emplace_back(docId, std::move(positions));
+                });
+                begin = end;
+            }
+        });
+
+        cout << threads << " | " << lockedSpeed << " | " << sharedSpeed << endl;
+    }
+}
+
+// Bytes taken by the postings, contexts and keys, allocator overhead is not counted.
+static double indexMemoryMb(const NGramIndex &index) {
+    return (index.contextBytes() + index.postingBytes()) / 1048576.0;
+}
+
+static vector<uint32_t> topDocuments(NGramIndex &index, unordered_map<wstring, vector<Word*>> *dictionary,
+                                     const wstring &request) {
+    vector<uint32_t> top;
+    for (const auto &scorePair : rankDocuments(index, requestTerms(index, dictionary, request))) {
+        if (top.size() == 10 || scorePair.second <= 0)
+            break;
+        top.push_back(scorePair.first);
+    }
+    return top;
+}
+
+void benchmarkPruning(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const vector<wstring> &requests, const IndexSettings &settings) {
+    struct Variant {
+        string name;
+        size_t minDf;
+        double maxDfRatio;
+        size_t topKPerOrder;
+        size_t sketchBytes;
+    };
+    const vector<Variant> variants{
+            {"none", 1, 1.0, 0, 0}, {"min-df 2", 2, 1.0, 0, 0}, {"min-df 3", 3, 1.0, 0, 0},
+            {"min-df 5", 5, 1.0, 0, 0}, {"max-df 0.5", 1, 0.5, 0, 0}, {"min-df 2, max-df 0.5", 2, 0.5, 0, 0},
+            {"top-k 10000", 1, 1.0, 10000, 0}, {"top-k 1000", 1, 1.0, 1000, 0}, {"top-k 10", 1, 1.0, 10, 0},
+            {"min-df 2, sketch 1 MB", 2, 1.0, 0, 1 << 20}, {"min-df 5, sketch 1 MB", 5, 1.0, 0, 1 << 20},
+            {"min-df 2, sketch 64 KB", 2, 1.0, 0, 1 << 16}};
+
+    vector<vector<uint32_t>> expected, expectedPhrases;
+    vector<string> rows;
+    for (const auto &variant : variants) {
+        IndexSettings variantSettings = settings;
+        variantSettings.minDf = variant.minDf;
+        variantSettings.maxDfRatio = variant.maxDfRatio;
+        variantSettings.topKPerOrder = variant.topKPerOrder;
+        variantSettings.sketchBytes = variant.sketchBytes;
+
+        auto begin = chrono::steady_clock::now();
+        NGramIndex index;
+        buildIndex(files, dictionary, relations, variantSettings, &index);
+        auto end = chrono::steady_clock::now();
+        double seconds = chrono::duration_cast<chrono::milliseconds>(end - begin).count() / 1000.0;
+
+        size_t found = 0, total = 0, phraseFound = 0, phraseTotal = 0;
+        bool first = expected.size() < requests.size();
+        for (size_t i = 0; i < requests.size(); i++) {
+            vector<uint32_t> top = topDocuments(index, dictionary, requests[i]);
+            // every request once more as a quoted phrase
+            vector<uint32_t> matched;
+            for (const auto &phrase : requestPhrases(index, dictionary, L"\"" + requests[i] + L"\""))
+                for (const auto &match : matchPhrase(index, phrase))
+                    matched.push_back(match.first);
+            if (first) {
+                expected.push_back(top);
+                expectedPhrases.push_back(matched);
+                continue;
+            }
+            for (uint32_t docId : expected[i])
+                found += find(top.begin(), top.end(), docId) != top.end();
+            total += expected[i].size();
+            for (uint32_t docId : expectedPhrases[i])
+                phraseFound += find(matched.begin(), matched.end(), docId) != matched.end();
+            phraseTotal += expectedPhrases[i].size();
+        }
+        double recall = total ? (double) found / total : 1.0;
+        double phraseRecall = phraseTotal ? (double) phraseFound / phraseTotal : 1.0;
+
+        rows.push_back(variant.name + " | " + to_string(index.phraseContexts.size()) + " | " +
+                       to_string(index.pruned) + " | " + to_string(indexMemoryMb(index)) + " | " +
+                       to_string(recall) + " | " + to_string(phraseRecall) + " | " + to_string(seconds));
+    }
+
+    size_t phraseMatches = 0;
+    for (const auto &matched : expectedPhrases)
+        phraseMatches += matched.size();
+    cout << "requests: " << requests.size() << ", phrase matches without pruning: " << phraseMatches << endl;
+    cout << "pruning | n-grams | pruned | index, MB | recall@10 | phrase recall | build, s" << endl;
+    for (const auto &row : rows)
+        cout << row << endl;
+}
+
+// Longest n-gram with postings at the start of lemmaIds by hashing every prefix, as
+// request lookup did before the trie.
+static int hashedLongestMatch(const NGramIndex &index, const uint32_t *lemmaIds, int count, uint64_t *key) {
+    for (int order = count; order > 0; order--) {
+        uint64_t probe = 0;
+        for (int i = order; i > 0; i--)
+            probe = prependLemma(probe, lemmaIds[i - 1]);
+        if (lookupContext(index.phraseContexts, &probe, order, [&](int i) { return lemmaIds[i]; }) &&
+            index.postings.count(probe)) {
+            *key = probe;
+            return order;
+        }
+    }
+    return 0;
+}
+
+void benchmarkTrie(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                   const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                   const IndexSettings &settings) {
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, settings, &index);
+
+    // every indexed n-gram extended by a random lemma, so both hits and misses are walked
+    mt19937 random(42);
+    vector<uint32_t> queries;
+    int width = settings.maxOrder + 1;
+    for (const auto &pairContext : index.phraseContexts) {
+        const auto &lemmaIds = pairContext.second->lemmas;
+        for (int i = 0; i < width; i++)
+            queries.push_back(i < (int) lemmaIds.size() ? lemmaIds[i] : random() % index.lemmas.size());
+    }
+    size_t queryCount = queries.size() / width;
+
+    uint64_t trieChecksum = 0, hashChecksum = 0;
+    double trieCost = nanosPerToken(queryCount, [&] {
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < queryCount; i++) {
+            uint64_t key = 0;
+            checksum += index.trie.longestMatch(&queries[i * width], width, &key) + key;
+        }
+        return checksum;
+    }, &trieChecksum);
+    double hashCost = nanosPerToken(queryCount, [&] {
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < queryCount; i++) {
+            uint64_t key = 0;
+            checksum += hashedLongestMatch(index, &queries[i * width], width, &key) + key;
+        }
+        return checksum;
+    }, &hashChecksum);
+
+    cout << "lookups: " << queryCount << ", trie: " << index.trie.size() << " nodes, "
+         << index.trie.bytes() / 1048576.0 << " MB" << endl;
+    cout << "hashed prefixes, ns/lookup | trie walk, ns/lookup" << endl;
+    cout << hashCost << " | " << trieCost << endl;
+    if (trieChecksum != hashChecksum)
+        cout << "Trie and hashed lookups disagree" << endl;
+}
+
+void benchmarkPostings(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                       const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                       const IndexSettings &settings) {
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, settings, &index);
+
+    // what an Entry kept before: the document id and a vector of positions
+    size_t documentCount = 0, positionCount = 0, vectorBytes = 0, compressedBytes = 0;
+    for (const auto &pairPostings : index.postings) {
+        for (const auto &entry : pairPostings.second.decode()) {
+            documentCount++;
+            positionCount += entry.second.size();
+            vectorBytes += sizeof(uint32_t) + sizeof(vector<int>) + entry.second.size() * sizeof(int);
+        }
+        compressedBytes += pairPostings.second.bytes();
+    }
+    size_t flatBytes = (documentCount * 2 + positionCount) * sizeof(uint32_t);
+
+    uint32_t docIds[PostingList::BLOCK_SIZE], counts[PostingList::BLOCK_SIZE];
+    uint64_t documentChecksum = 0, positionChecksum = 0;
+    double documentCost = nanosPerToken(documentCount * 2, [&] {
+        uint64_t checksum = 0;
+        for (const auto &pairPostings : index.postings) {
+            const PostingList &postings = pairPostings.second;
+            for (size_t block = 0; block < postings.blockCount(); block++) {
+                size_t count = postings.decodeBlock(block, docIds, counts);
+                for (size_t i = 0; i < count; i++)
+                    checksum += docIds[i] + counts[i];
+            }
+        }
+        return checksum;
+    }, &documentChecksum);
+    vector<int> positions;
+    double positionCost = nanosPerToken(positionCount, [&] {
+        uint64_t checksum = 0;
+        for (const auto &pairPostings : index.postings) {
+            const PostingList &postings = pairPostings.second;
+            for (size_t block = 0; block < postings.blockCount(); block++) {
+                size_t count = postings.decodeBlock(block, docIds, counts);
+                postings.decodePositions(block, counts, count, &positions);
+                for (int position : positions)
+                    checksum += position;
+            }
+        }
+        return checksum;
+    }, &positionChecksum);
+
+    cout << "n-grams: " << index.postings.size() << ", postings: " << documentCount
+         << ", positions: " << positionCount << endl;
+    cout << "vector<int> entries, MB | flat 32-bit, MB | compressed, MB | ratio to entries | ratio to flat" << endl;
+    cout << vectorBytes / 1048576.0 << " | " << flatBytes / 1048576.0 << " | " << compressedBytes / 1048576.0
+         << " | " << (double) vectorBytes / compressedBytes << " | " << (double) flatBytes / compressedBytes << endl;
+    cout << "decode ids and counts, M ints/s | decode with positions, M ints/s" << endl;
+    cout << 1000.0 / documentCost << " | " << 1000.0 / positionCost << endl;
+}
+
+void benchmarkPhrases(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const IndexSettings &settings) {
+    // longer n-grams are materialized too, to have phrases to look up and compare with
+    IndexSettings phraseSettings = settings;
+    phraseSettings.maxOrder = max(settings.maxOrder, 5);
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, phraseSettings, &index);
+
+    const size_t SAMPLE = 1000;
+    mt19937 random(42);
+    vector<vector<vector<uint32_t>>> phrases(phraseSettings.maxOrder + 1);
+    vector<size_t> postingBytes(phraseSettings.maxOrder + 1, 0);
+    for (const auto &pairPostings : index.postings) {
+        const auto &lemmaIds = index.phraseContexts.at(pairPostings.first)->lemmas;
+        phrases[lemmaIds.size()].push_back(lemmaIds);
+        postingBytes[lemmaIds.size()] += pairPostings.second.bytes();
+    }
+
+    cout << "order | phrases | postings, MB | n-gram lookup, us/phrase | positional, us/phrase | "
+            "slop 2, us/phrase | same documents" << endl;
+    for (int order = 2; order <= phraseSettings.maxOrder; order++) {
+        auto &sample = phrases[order];
+        shuffle(sample.begin(), sample.end(), random);
+        sample.resize(min(sample.size(), SAMPLE));
+        if (sample.empty())
+            continue;
+
+        vector<vector<pair<uint32_t, uint32_t>>> lookedUp(sample.size()), matched(sample.size());
+        uint64_t lookupChecksum = 0, phraseChecksum = 0, slopChecksum = 0;
+        double lookupCost = nanosPerToken(sample.size(), [&] {
+            for (size_t i = 0; i < sample.size(); i++) {
+                uint64_t key;
+                index.trie.longestMatch(sample[i].data(), order, &key);
+                // entries without positions were only added for thesaurus relations
+                for (PostingCursor cursor(index.postings.at(key)); !cursor.atEnd(); cursor.next())
+                    if (cursor.count() > 0)
+                        lookedUp[i].emplace_back(cursor.docId(), cursor.count());
+            }
+            return (uint64_t) 0;
+        }, &lookupChecksum);
+        double phraseCost = nanosPerToken(sample.size(), [&] {
+            for (size_t i = 0; i < sample.size(); i++)
+                matched[i] = matchPhrase(index, sample[i]);
+            return (uint64_t) 0;
+        }, &phraseChecksum);
+        double slopCost = nanosPerToken(sample.size(), [&] {
+            uint64_t checksum = 0;
+            for (const auto &phrase : sample)
+                checksum += matchPhrase(index, phrase, 2).size();
+            return checksum;
+        }, &slopChecksum);
+
+        size_t same = 0;
+        for (size_t i = 0; i < sample.size(); i++)
+            same += lookedUp[i] == matched[i];
+        cout << order << " | " << sample.size() << " | " << postingBytes[order] / 1048576.0 << " | "
+             << lookupCost / 1000 << " | " << phraseCost / 1000 << " | " << slopCost / 1000 << " | "
+             << same << "/" << sample.size() << endl;
+    }
+    cout << "unigram postings, MB: " << postingBytes[1] / 1048576.0 << endl;
+}
+
+void benchmarkSuffixArray(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                          const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                          const IndexSettings &settings) {
+    IndexSettings suffixSettings = settings;
+    suffixSettings.buildSuffixArray = true;
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, suffixSettings, &index);
+
+    // the same stream once more, to time the suffix array alone
+    DocumentTable documents;
+    vector<uint32_t> lemmaStream, documentStarts;
+    readAllTexts(files, dictionary, &documents, settings, false,
+                 [&](uint32_t, const vector<Word*> &fileContent, const TextBoundaries &) {
+        documentStarts.push_back((uint32_t) lemmaStream.size());
+        for (Word *word : fileContent)
+            lemmaStream.push_back(index.lemmas.id(word));
+    });
+    vector<int> threadCounts{1};
+    if (settings.threads > 1)
+        threadCounts.push_back(settings.threads);
+    cout << "tokens: " << lemmaStream.size() << ", documents: " << documentStarts.size() << endl;
+    cout << "threads | build, s | suffix array, MB" << endl;
+    for (int threads : threadCounts) {
+        SuffixArray suffixArray;
+        auto begin = chrono::steady_clock::now();
+        suffixArray.build(lemmaStream, documentStarts, threads);
+        auto end = chrono::steady_clock::now();
+        cout << threads << " | " << chrono::duration_cast<chrono::milliseconds>(end - begin).count() / 1000.0
+             << " | " << suffixArray.bytes() / 1048576.0 << endl;
+    }
+
+    // indexed n-grams looked up in both
+    const size_t SAMPLE = 1000;
+    mt19937 random(42);
+    vector<vector<uint32_t>> sample;
+    for (const auto &pairPostings : index.postings)
+        sample.push_back(index.phraseContexts.at(pairPostings.first)->lemmas);
+    shuffle(sample.begin(), sample.end(), random);
+    sample.resize(min(sample.size(), SAMPLE));
+
+    vector<vector<pair<uint32_t, uint32_t>>> lookedUp(sample.size()), found(sample.size());
+    uint64_t lookupChecksum = 0, suffixChecksum = 0;
+    double lookupCost = nanosPerToken(sample.size(), [&] {
+        for (size_t i = 0; i < sample.size(); i++) {
+            uint64_t key;
+            index.trie.longestMatch(sample[i].data(), (int) sample[i].size(), &key);
+            for (PostingCursor cursor(index.postings.at(key)); !cursor.atEnd(); cursor.next())
+                if (cursor.count() > 0)
+                    lookedUp[i].emplace_back(cursor.docId(), cursor.count());
+        }
+        return (uint64_t) 0;
+    }, &lookupChecksum);
+    double suffixCost = nanosPerToken(sample.size(), [&] {
+        for (size_t i = 0; i < sample.size(); i++)
+            found[i] = index.suffixArray.occurrences(sample[i].data(), sample[i].size(), index.documents);
+        return (uint64_t) 0;
+    }, &suffixChecksum);
+    size_t same = 0;
+    for (size_t i = 0; i < sample.size(); i++)
+        same += lookedUp[i] == found[i];
+    cout << "n-grams | n-gram lookup, us | suffix array, us | same documents" << endl;
+    cout << sample.size() << " | " << lookupCost / 1000 << " | " << suffixCost / 1000 << " | "
+         << same << "/" << sample.size() << endl;
+
+    cout << "length | repeated sequences" << endl;
+    for (uint32_t length : {2, 3, 5, 10, 20})
+        cout << length << " | " << index.suffixArray.repeatedSequences(length) << endl;
+    cout << "longest repeat: " << index.suffixArray.longestRepeat() << " tokens" << endl;
+}
+
+void benchmarkFmIndex(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const IndexSettings &settings) {
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, settings, &index);
+
+    DocumentTable documents;
+    vector<uint32_t> lemmaStream, documentStarts;
+    readAllTexts(files, dictionary, &documents, settings, false,
+                 [&](uint32_t, const vector<Word*> &fileContent, const TextBoundaries &) {
+        documentStarts.push_back((uint32_t) lemmaStream.size());
+        for (Word *word : fileContent)
+            lemmaStream.push_back(index.lemmas.id(word));
+    });
+    SuffixArray suffixArray;
+    suffixArray.build(lemmaStream, documentStarts, settings.threads);
+
+    size_t streamBytes = lemmaStream.size() * sizeof(uint32_t);
+    cout << "tokens: " << lemmaStream.size() << ", lemmas: " << index.lemmas.size() << endl;
+    cout << "lemma ids, MB: " << streamBytes / 1048576.0;
+#ifdef TEXTREADER_HAVE_ZLIB
+    uLongf compressedBytes = compressBound(streamBytes);
+    vector<Bytef> compressed(compressedBytes);
+    compress2(compressed.data(), &compressedBytes, reinterpret_cast<const Bytef *>(lemmaStream.data()),
+              streamBytes, 9);
+    cout << ", zlib -9, MB: " << compressedBytes / 1048576.0;
+#endif
+    cout << ", suffix array, MB: " << suffixArray.bytes() / 1048576.0 << endl;
+    // the FM-index is built next to these, it serves quoted phrases only
+    cout << "postings and contexts, MB: " << indexMemoryMb(index) << ", trie, MB: "
+         << index.trie.bytes() / 1048576.0 << endl;
+
+    const size_t SAMPLE = 1000;
+    mt19937 random(42);
+    vector<vector<uint32_t>> sample;
+    for (const auto &pairPostings : index.postings)
+        sample.push_back(index.phraseContexts.at(pairPostings.first)->lemmas);
+    shuffle(sample.begin(), sample.end(), random);
+    sample.resize(min(sample.size(), SAMPLE));
+
+    cout << "sample rate | FM-index, MB | build, s | count, us | occurrences, us | same documents" << endl;
+    for (uint32_t sampleRate : {8, 32, 128}) {
+        FMIndex fmIndex;
+        auto begin = chrono::steady_clock::now();
+        fmIndex.build(suffixArray, sampleRate);
+        auto end = chrono::steady_clock::now();
+
+        uint64_t countChecksum = 0, locateChecksum = 0;
+        double countCost = nanosPerToken(sample.size(), [&] {
+            uint64_t checksum = 0;
+            for (const auto &lemmaIds : sample) {
+                auto range = fmIndex.find(lemmaIds.data(), lemmaIds.size());
+                checksum += range.second - range.first;
+            }
+            return checksum;
+        }, &countChecksum);
+        vector<vector<pair<uint32_t, uint32_t>>> found(sample.size());
+        double locateCost = nanosPerToken(sample.size(), [&] {
+            for (size_t i = 0; i < sample.size(); i++)
+                found[i] = fmIndex.occurrences(sample[i].data(), sample[i].size(), index.documents);
+            return (uint64_t) 0;
+        }, &locateChecksum);
+
+        size_t same = 0;
+        for (size_t i = 0; i < sample.size(); i++)
+            same += found[i] == suffixArray.occurrences(sample[i].data(), sample[i].size(), index.documents);
+        cout << sampleRate << " | " << fmIndex.bytes() / 1048576.0 << " | "
+             << chrono::duration_cast<chrono::milliseconds>(end - begin).count() / 1000.0 << " | "
+             << countCost / 1000 << " | " << locateCost / 1000 << " | " << same << "/" << sample.size() << endl;
+    }
+}
+
+void benchmarkBitmaps(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const IndexSettings &settings) {
+    IndexSettings listSettings = settings;
+    listSettings.bitmapDfRatio = 2.0;
+    NGramIndex lists, hybrid;
+    buildIndex(files, dictionary, relations, listSettings, &lists);
+    buildIndex(files, dictionary, relations, settings, &hybrid);
+
+    size_t listBytes = 0, hybridBytes = 0, bitmaps = 0;
+    for (const auto &pairPostings : lists.postings)
+        listBytes += pairPostings.second.bytes();
+    for (const auto &pairPostings : hybrid.postings) {
+        hybridBytes += pairPostings.second.bytes();
+        bitmaps += pairPostings.second.bitmap() != nullptr;
+    }
+    cout << "n-grams: " << hybrid.postings.size() << ", with bitmaps: " << bitmaps << endl;
+    cout << "lists only, MB: " << listBytes / 1048576.0 << ", hybrid, MB: " << hybridBytes / 1048576.0 << endl;
+
+    // n-grams on both sides of the bitmap threshold
+    double bitmapDf = settings.bitmapDfRatio * hybrid.documents.size();
+    vector<const vector<uint32_t>*> frequent, rare;
+    for (const auto &pairPostings : hybrid.postings) {
+        const auto &lemmaIds = hybrid.phraseContexts.at(pairPostings.first)->lemmas;
+        (pairPostings.second.size() >= bitmapDf ? frequent : rare).push_back(&lemmaIds);
+    }
+    auto postingsOf = [](const NGramIndex &index, const vector<uint32_t> *lemmaIds) -> const PostingList & {
+        uint64_t key;
+        index.trie.longestMatch(lemmaIds->data(), (int) lemmaIds->size(), &key);
+        return index.postings.at(key);
+    };
+
+    const size_t PAIRS = 200;
+    mt19937 random(42);
+    const vector<pair<string, pair<decltype(&frequent), decltype(&frequent)>>> pairings{
+            {"frequent & frequent", {&frequent, &frequent}}, {"frequent & rare", {&frequent, &rare}},
+            {"rare & rare", {&rare, &rare}}};
+    cout << "pairing | pairs | intersect lists, us | intersect hybrid, us | unite lists, us | "
+            "unite hybrid, us | same" << endl;
+    for (const auto &pairing : pairings) {
+        if (pairing.second.first->empty() || pairing.second.second->empty())
+            continue;
+        vector<pair<const vector<uint32_t>*, const vector<uint32_t>*>> pairs;
+        for (size_t i = 0; i < PAIRS; i++)
+            pairs.emplace_back((*pairing.second.first)[random() % pairing.second.first->size()],
+                               (*pairing.second.second)[random() % pairing.second.second->size()]);
+
+        auto timeOperation = [&](const NGramIndex &index, bool intersect, vector<vector<uint32_t>> *results) {
+            uint64_t checksum = 0;
+            return nanosPerToken(pairs.size(), [&] {
+                for (const auto &termPair : pairs) {
+                    const PostingList &a = postingsOf(index, termPair.first), &b = postingsOf(index, termPair.second);
+                    DocumentSet documents = intersect ? intersectDocuments(a, b) : uniteDocuments(a, b);
+                    results->push_back(documents.toVector());
+                }
+                return (uint64_t) 0;
+            }, &checksum);
+        };
+        vector<vector<uint32_t>> listIntersections, hybridIntersections, listUnions, hybridUnions;
+        double listIntersect = timeOperation(lists, true, &listIntersections);
+        double hybridIntersect = timeOperation(hybrid, true, &hybridIntersections);
+        double listUnite = timeOperation(lists, false, &listUnions);
+        double hybridUnite = timeOperation(hybrid, false, &hybridUnions);
+        bool same = listIntersections == hybridIntersections && listUnions == hybridUnions;
+        cout << pairing.first << " | " << pairs.size() << " | " << listIntersect / 1000 << " | "
+             << hybridIntersect / 1000 << " | " << listUnite / 1000 << " | " << hybridUnite / 1000 << " | "
+             << (same ? "yes" : "no") << endl;
+    }
+}
+
+// Terms of the requests, then random queries of 2..4 indexed words up to 500 in all.
+static vector<vector<uint64_t>> rankingQueries(NGramIndex &index, unordered_map<wstring, vector<Word*>> *dictionary,
+                                               const vector<wstring> &requests) {
+    const size_t QUERIES = 500;
+    mt19937 random(42);
+    vector<vector<uint64_t>> queries;
+    for (const auto &request : requests)
+        queries.push_back(requestTerms(index, dictionary, request));
+    vector<uint64_t> unigrams;
+    for (const auto &pairPostings : index.postings)
+        if (index.phraseContexts.at(pairPostings.first)->lemmas.size() == 1)
+            unigrams.push_back(pairPostings.first);
+    sort(unigrams.begin(), unigrams.end());
+    while (queries.size() < QUERIES && !unigrams.empty()) {
+        queries.emplace_back();
+        for (size_t i = 0, words = 2 + random() % 3; i < words; i++)
+            queries.back().push_back(unigrams[random() % unigrams.size()]);
+    }
+    return queries;
+}
+
+void benchmarkImpacts(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const vector<wstring> &requests, const IndexSettings &settings) {
+    IndexSettings impactSettings = settings;
+    impactSettings.buildImpacts = true;
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, impactSettings, &index);
+    size_t postingBytes = 0;
+    for (const auto &pairPostings : index.postings)
+        postingBytes += pairPostings.second.bytes();
+    cout << "postings, MB: " << postingBytes / 1048576.0 << ", impacts, MB: " << index.impacts.bytes() / 1048576.0
+         << endl;
+
+    vector<vector<uint64_t>> queries = rankingQueries(index, dictionary, requests);
+
+    const size_t TOP = 10;
+    auto topOf = [&](const vector<pair<uint32_t, double>> &ranked) {
+        vector<uint32_t> top;
+        for (const auto &scorePair : ranked) {
+            if (top.size() == TOP || scorePair.second <= 0)
+                break;
+            top.push_back(scorePair.first);
+        }
+        return top;
+    };
+    vector<vector<uint32_t>> exact(queries.size());
+    uint64_t checksum = 0;
+    double exhaustiveCost = nanosPerToken(queries.size(), [&] {
+        for (size_t i = 0; i < queries.size(); i++)
+            exact[i] = topOf(rankDocuments(index, queries[i]));
+        return (uint64_t) 0;
+    }, &checksum);
+    cout << "queries: " << queries.size() << endl;
+    cout << "ranking | us/query | postings read | overlap@10 | same ranking as all postings" << endl;
+    cout << "exhaustive BM25 | " << exhaustiveCost / 1000 << " | 1 | 1 | -" << endl;
+
+    vector<vector<uint32_t>> allPostings;
+    for (bool earlyTermination : {false, true}) {
+        vector<vector<uint32_t>> found(queries.size());
+        double cost = nanosPerToken(queries.size(), [&] {
+            for (size_t i = 0; i < queries.size(); i++)
+                found[i] = topOf(rankByImpact(index, queries[i], TOP, earlyTermination));
+            return (uint64_t) 0;
+        }, &checksum);
+        size_t read = 0, total = 0, same = 0, expected = 0, sameRanking = 0;
+        if (!earlyTermination)
+            allPostings = found;
+        for (size_t i = 0; i < queries.size(); i++) {
+            sameRanking += found[i] == allPostings[i];
+            size_t processed, all;
+            rankByImpact(index, queries[i], TOP, earlyTermination, &processed);
+            rankByImpact(index, queries[i], TOP, false, &all);
+            read += processed;
+            total += all;
+            for (uint32_t docId : exact[i])
+                same += find(found[i].begin(), found[i].end(), docId) != found[i].end();
+            expected += exact[i].size();
+        }
+        cout << (earlyTermination ? "impacts, early termination" : "impacts, all postings") << " | " << cost / 1000
+             << " | " << (total ? (double) read / total : 1.0) << " | " << (expected ? (double) same / expected : 1.0)
+             << " | " << (double) sameRanking / queries.size() << endl;
+    }
+}
+
+void benchmarkBlockMax(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                       const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                       const vector<wstring> &requests, const IndexSettings &settings) {
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, settings, &index);
+    size_t postingBytes = 0, blocks = 0;
+    for (const auto &pairPostings : index.postings) {
+        postingBytes += pairPostings.second.bytes();
+        blocks += pairPostings.second.blockCount();
+    }
+    cout << "blocks: " << blocks << ", block maxima, MB: " << blocks * sizeof(float) / 1048576.0
+         << ", postings, MB: " << postingBytes / 1048576.0 << endl;
+
+    // the bound of every block against the scores of its documents
+    double averageLength = index.documents.averageLength();
+    size_t postings = 0, above = 0;
+    double tightness = 0;
+    for (const auto &pairPostings : index.postings) {
+        const PostingList &list = pairPostings.second;
+        for (PostingCursor cursor(list); !cursor.atEnd(); cursor.next()) {
+            double score = postingScore(index.documents, averageLength, cursor.docId(), cursor.count(), list.size());
+            above += score > cursor.blockMaxScore();
+            if (cursor.blockMaxScore() > 0)
+                tightness += score / cursor.blockMaxScore();
+            postings++;
+        }
+    }
+    cout << "postings: " << postings << ", above their block bound: " << above
+         << ", mean score / bound: " << (postings ? tightness / postings : 0) << endl;
+
+    // documents whose summed block bounds stay below the exact 10th score, which a
+    // block-max pruner would skip without decoding
+    vector<vector<uint64_t>> queries = rankingQueries(index, dictionary, requests);
+    size_t candidates = 0, skipped = 0, missed = 0;
+    for (const auto &query : queries) {
+        vector<pair<uint32_t, double>> ranked = rankDocuments(index, query);
+        double threshold = ranked.size() >= 10 ? ranked[9].second : 0;
+        if (threshold <= 0)
+            continue;
+        vector<double> exact(index.documents.size(), 0);
+        for (const auto &scorePair : ranked)
+            exact[scorePair.first] = scorePair.second;
+
+        vector<PostingCursor> cursors;
+        vector<double> weights;
+        for (uint64_t term : query) {
+            if (index.postings.find(term) == index.postings.end())
+                continue;
+            cursors.emplace_back(index.postings.at(term));
+            weights.push_back(1.0);
+            auto related = index.relations.find(term);
+            if (related == index.relations.end())
+                continue;
+            for (const auto &relation : related->second) {
+                auto found = index.postings.find(relation.first);
+                if (found == index.postings.end())
+                    continue;
+                cursors.emplace_back(found->second);
+                weights.push_back(relation.second ? 0.9 : 0.6);
+            }
+        }
+        for (uint32_t docId = 0;; docId++) {
+            uint32_t nextDocId = UINT32_MAX;
+            for (auto &cursor : cursors)
+                if (cursor.advance(docId))
+                    nextDocId = min(nextDocId, cursor.docId());
+            if (nextDocId == UINT32_MAX)
+                break;
+            docId = nextDocId;
+            double bound = 0;
+            for (size_t i = 0; i < cursors.size(); i++)
+                bound += weights[i] * cursors[i].blockMaxScore(docId);
+            candidates++;
+            if (bound < threshold) {
+                skipped++;
+                missed += exact[docId] >= threshold;
+            }
+        }
+    }
+    cout << "queries: " << queries.size() << ", candidate documents: " << candidates << ", skipped: " << skipped
+         << " (" << (candidates ? (double) skipped / candidates : 0) << "), top 10 lost: " << missed << endl;
+}
+
+void benchmarkChampions(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                        const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                        const vector<wstring> &requests, const IndexSettings &settings) {
+    NGramIndex index;
+    buildIndex(files, dictionary, relations, settings, &index);
+    vector<vector<uint64_t>> queries = rankingQueries(index, dictionary, requests);
+
+    const size_t TOP = 10;
+    auto topOf = [&](const vector<pair<uint32_t, double>> &ranked) {
+        vector<uint32_t> top;
+        for (const auto &scorePair : ranked) {
+            if (top.size() == TOP || scorePair.second <= 0)
+                break;
+            top.push_back(scorePair.first);
+        }
+        return top;
+    };
+    vector<vector<uint32_t>> exact(queries.size());
+    uint64_t checksum = 0;
+    double exhaustiveCost = nanosPerToken(queries.size(), [&] {
+        for (size_t i = 0; i < queries.size(); i++)
+            exact[i] = topOf(rankDocuments(index, queries[i]));
+        return (uint64_t) 0;
+    }, &checksum);
+    cout << "queries: " << queries.size() << endl;
+    cout << "champions | lists, MB | build, s | us/query | fell back | overlap@10" << endl;
+    cout << "all postings | - | - | " << exhaustiveCost / 1000 << " | - | 1" << endl;
+
+    for (size_t size : {10, 50, 200, 1000}) {
+        auto begin = chrono::steady_clock::now();
+        buildChampionLists(&index, size);
+        auto end = chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (const auto &pairChampions : index.champions)
+            bytes += sizeof(uint64_t) + sizeof(ChampionList) +
+                     (pairChampions.second.docIds.capacity() + pairChampions.second.counts.capacity()) * sizeof(uint32_t);
+
+        vector<vector<uint32_t>> found(queries.size());
+        size_t fallbacks = 0;
+        double cost = nanosPerToken(queries.size(), [&] {
+            fallbacks = 0;
+            for (size_t i = 0; i < queries.size(); i++) {
+                bool fellBack;
+                found[i] = topOf(rankByChampions(index, queries[i], TOP, &fellBack));
+                fallbacks += fellBack;
+            }
+            return (uint64_t) 0;
+        }, &checksum);
+        size_t same = 0, expected = 0;
+        for (size_t i = 0; i < queries.size(); i++) {
+            for (uint32_t docId : exact[i])
+                same += find(found[i].begin(), found[i].end(), docId) != found[i].end();
+            expected += exact[i].size();
+        }
+        cout << size << " | " << bytes / 1048576.0 << " | "
+             << chrono::duration_cast<chrono::milliseconds>(end - begin).count() / 1000.0 << " | " << cost / 1000
+             << " | " << (double) fallbacks / queries.size() << " | " << (expected ? (double) same / expected : 1.0)
+             << endl;
+    }
+}
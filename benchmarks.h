@@ -0,0 +1,88 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_BENCHMARKS_H
+#define LABS_BENCHMARKS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "dictionary.h"
+#include "NGramIndex.h"
+
+// Peak resident set size of the process so far.
+double peakMemoryMb();
+
+// Per-token cost of the n-gram window: the old vector window against NGramWindow.
+void benchmarkWindow();
+
+// Index build time with 1..all cores in every build mode, every index is checked
+// against the single-threaded one.
+void benchmarkBuild(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                    const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                    const IndexSettings &settings);
+
+// Insert-or-find throughput on a Zipf-skewed key stream with 1..64 threads:
+// one mutex around an unordered_map against ConcurrentNGramMap.
+void benchmarkConcurrentMap();
+
+// Size of the index against top-10 recall on requests under document frequency pruning,
+// recall is the share of the unpruned top 10 that is still found.
+void benchmarkPruning(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const vector<wstring> &requests, const IndexSettings &settings);
+
+// Longest-match lookup of n-grams: hashing every prefix against one walk of NGramTrie.
+void benchmarkTrie(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                   const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                   const IndexSettings &settings);
+
+// Size of the compressed postings against vectors of positions, and decoding speed.
+void benchmarkPostings(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                       const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                       const IndexSettings &settings);
+
+// Phrases of 2..5 words: lookup of the materialized n-gram against matchPhrase over
+// unigram postings, with the share of phrases both find in the same documents.
+void benchmarkPhrases(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const IndexSettings &settings);
+
+// Suffix array build time and size, and lookups of indexed n-grams in it
+// against the postings.
+void benchmarkSuffixArray(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                          const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                          const IndexSettings &settings);
+
+// FM-index size against the raw lemma stream, the zlib-compressed one when zlib is there
+// and the suffix array, with count and locate times of indexed n-grams for several sample rates.
+void benchmarkFmIndex(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const IndexSettings &settings);
+
+// Postings size and intersection and union times with document id lists only against
+// bitmaps for frequent n-grams, for every pairing of frequent and rare n-grams.
+void benchmarkBitmaps(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const IndexSettings &settings);
+
+// Top 10 of exhaustive BM25 against quantized impacts with and without early termination:
+// time per query, share of postings read and overlap with the exact top 10.
+void benchmarkImpacts(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                      const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                      const vector<wstring> &requests, const IndexSettings &settings);
+
+// Size of the block-max scores, whether any posting scores above its block bound, and the
+// share of candidate documents block bounds rule out against the exact 10th score.
+void benchmarkBlockMax(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                       const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                       const vector<wstring> &requests, const IndexSettings &settings);
+
+// Top 10 from champion lists of several sizes against exhaustive BM25: time per query,
+// share of queries that fall back to full postings, overlap and size of the lists.
+void benchmarkChampions(const vector<string> &files, unordered_map<wstring, vector<Word*>> *dictionary,
+                        const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                        const vector<wstring> &requests, const IndexSettings &settings);
+
+#endif //LABS_BENCHMARKS_H
@@ -5,6 +5,7 @@
 #ifndef LABS_DICTIONARY_H
 #define LABS_DICTIONARY_H
 
+#include <cstdint>
 #include <string>
 #include "filemap.h"
 #include "set"
@@ -15,6 +16,9 @@ using namespace std;
 class Word {
 public:
     int totalEntryCount = 0;
+    // id in the LemmaTable with serial lemmaTable, stale for any other table
+    int lemmaId = -1;
+    uint32_t lemmaTable = 0;
     set <string> textEntry;
     wstring word;
     wstring partOfSpeech;
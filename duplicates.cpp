@@ -0,0 +1,134 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "duplicates.h"
+
+#include <functional>
+#include <limits>
+#include <unordered_set>
+
+static uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+DuplicateDetector::DuplicateDetector(int maxOrder, double threshold) {
+    this->maxOrder = maxOrder;
+    this->threshold = threshold;
+}
+
+uint64_t DuplicateDetector::lemmaHash(const Word *word) {
+    auto found = lemmaHashes.find(word);
+    if (found != lemmaHashes.end())
+        return found->second;
+
+    uint64_t hash = mix(std::hash<wstring>()(word->word));
+    lemmaHashes.emplace(word, hash);
+    return hash;
+}
+
+void DuplicateDetector::computeSignature(const vector<Word*> &content, uint64_t *signature) {
+    for (int i = 0; i < SIGNATURE_SIZE; i++)
+        signature[i] = numeric_limits<uint64_t>::max();
+
+    size_t shingleCount = content.size() < SHINGLE_SIZE ? 1 : content.size() - SHINGLE_SIZE + 1;
+    for (size_t begin = 0; begin < shingleCount; begin++) {
+        uint64_t shingle = 0;
+        for (size_t i = begin; i < min(begin + SHINGLE_SIZE, content.size()); i++)
+            shingle = mix(shingle ^ lemmaHash(content[i]));
+
+        for (int i = 0; i < SIGNATURE_SIZE; i++) {
+            uint64_t value = mix(shingle + (uint64_t) i * 0x632be59bd9b4e019ULL);
+            if (value < signature[i])
+                signature[i] = value;
+        }
+    }
+}
+
+bool DuplicateDetector::isDuplicate(const vector<Word*> &content) {
+    if (content.empty())
+        return false;
+
+    uint64_t signature[SIGNATURE_SIZE];
+    computeSignature(content, signature);
+
+    uint64_t bandKeys[BANDS];
+    for (int band = 0; band < BANDS; band++) {
+        uint64_t key = 0;
+        for (int row = 0; row < ROWS; row++)
+            key = mix(key ^ signature[band * ROWS + row]);
+        bandKeys[band] = key;
+    }
+
+    unordered_set<uint32_t> checked;
+    for (int band = 0; band < BANDS; band++) {
+        auto bucket = buckets[band].find(bandKeys[band]);
+        if (bucket == buckets[band].end())
+            continue;
+
+        for (uint32_t candidate : bucket->second) {
+            if (!checked.insert(candidate).second)
+                continue;
+
+            const uint64_t *candidateSignature = &signatures[(size_t) candidate * SIGNATURE_SIZE];
+            int equal = 0;
+            for (int i = 0; i < SIGNATURE_SIZE; i++)
+                equal += signature[i] == candidateSignature[i];
+
+            if ((double) equal / SIGNATURE_SIZE >= threshold) {
+                duplicateCount++;
+                droppedTokens += content.size();
+                droppedIndexBytes += estimateIndexBytes(content);
+                return true;
+            }
+        }
+    }
+
+    auto docId = (uint32_t) (signatures.size() / SIGNATURE_SIZE);
+    signatures.insert(signatures.end(), signature, signature + SIGNATURE_SIZE);
+    for (int band = 0; band < BANDS; band++)
+        buckets[band][bandKeys[band]].push_back(docId);
+    return false;
+}
+
+// Bytes of a value in the variable-byte tail of a PostingCodec stream, close to
+// what it takes in a packed block.
+static size_t codedBytes(uint32_t value) {
+    size_t bytes = 1;
+    while (value >= 128) {
+        value >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+// What the document would have added to the compressed postings: a document id gap
+// and a position count for every distinct 1..maxOrder-gram, and the gaps between its
+// positions. A near-duplicate shares almost all n-grams with the document it repeats,
+// so their contexts and posting lists exist anyway and are not counted.
+size_t DuplicateDetector::estimateIndexBytes(const vector<Word*> &content) {
+    struct Occurrences {
+        uint32_t lastPosition;
+        uint32_t count;
+    };
+    unordered_map<uint64_t, Occurrences> ngrams;
+    size_t bytes = 0;
+    for (size_t begin = 0; begin < content.size(); begin++) {
+        uint64_t key = 0;
+        for (size_t i = begin; i < min(begin + (size_t) maxOrder, content.size()); i++) {
+            key = mix(key ^ lemmaHash(content[i]));
+            auto found = ngrams.emplace(key, Occurrences{0, 0}).first;
+            bytes += codedBytes((uint32_t) begin - found->second.lastPosition);
+            found->second.lastPosition = (uint32_t) begin;
+            found->second.count++;
+        }
+    }
+
+    // the document ids of a list are dense, so its gap takes one byte
+    for (const auto &ngram : ngrams)
+        bytes += 1 + codedBytes(ngram.second.count);
+    return bytes;
+}
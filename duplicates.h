@@ -0,0 +1,46 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_DUPLICATES_H
+#define LABS_DUPLICATES_H
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "dictionary.h"
+
+using namespace std;
+
+// MinHash over lemma shingles with LSH banding. Documents are checked one by one
+// as they are read: a document is compared only with the earlier documents that
+// share at least one band, and the first document of a group stays canonical.
+class DuplicateDetector {
+public:
+    static const int SHINGLE_SIZE = 3;
+    static const int BANDS = 16;
+    static const int ROWS = 4;
+    static const int SIGNATURE_SIZE = BANDS * ROWS;
+
+    int duplicateCount = 0;
+    size_t droppedTokens = 0;
+    size_t droppedIndexBytes = 0;
+
+    // maxOrder is the one of the index, for the estimate of the bytes saved
+    explicit DuplicateDetector(int maxOrder, double threshold = 0.8);
+
+    bool isDuplicate(const vector<Word*> &content);
+
+private:
+    int maxOrder;
+    double threshold;
+    vector<uint64_t> signatures;
+    unordered_map<uint64_t, vector<uint32_t>> buckets[BANDS];
+    unordered_map<const Word*, uint64_t> lemmaHashes;
+
+    uint64_t lemmaHash(const Word *word);
+    void computeSignature(const vector<Word*> &content, uint64_t *signature);
+    size_t estimateIndexBytes(const vector<Word*> &content);
+};
+
+#endif //LABS_DUPLICATES_H
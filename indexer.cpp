@@ -0,0 +1,793 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "indexer.h"
+#include "textreader.h"
+#include "duplicates.h"
+#include "NGramWindow.h"
+#include "NGramKey.h"
+#include "BlockingQueue.h"
+#include "ConcurrentNGramMap.h"
+#include "RadixSort.h"
+#include "CountMinSketch.h"
+#include "search.h"
+
+#include <iostream>
+#include <codecvt>
+#include <cstring>
+#include <chrono>
+#include <locale>
+#include <algorithm>
+#include <unordered_set>
+#include <cmath>
+
+using namespace std;
+
+static void tokenizeLine(const wstring &line, unordered_map <wstring, vector<Word*>> *dictionary,
+                  vector<Word*> &fileContent, TextBoundaries *boundaries) {
+    auto &f = std::use_facet<std::ctype<wchar_t>>(std::locale());
+    wstring const delims{L" :;.,!?() \r\n"};
+
+    size_t beg, pos = 0;
+    while ((beg = line.find_first_not_of(delims, pos)) != string::npos) {
+        pos = line.find_first_of(delims, beg + 1);
+        wstring wordStr = line.substr(beg, pos - beg);
+
+        f.toupper(&wordStr[0], &wordStr[0] + wordStr.size());
+
+        if (dictionary->find(wordStr) == dictionary->end()) {
+            Word *newWord = new Word();
+            newWord->word = wordStr;
+            newWord->partOfSpeech = L"UNKW";
+            dictionary->emplace(newWord->word, vector<Word *>{newWord});
+        }
+
+        vector<Word *> &words = dictionary->at(wordStr);
+        fileContent.push_back(words.at(0));
+
+        if (pos != string::npos && (line[pos] == L'.' || line[pos] == L',' ||
+                                    line[pos] == L'!' || line[pos] == L'?')) {
+            wstring punct;
+            punct.push_back(line[pos]);
+            if (dictionary->find(punct) == dictionary->end()) {
+                Word *newWord = new Word();
+                newWord->word = punct;
+                newWord->partOfSpeech = L"UNKW";
+                dictionary->emplace(newWord->word, vector<Word *>{newWord});
+            }
+
+            vector<Word *> &wordsPunct = dictionary->at(punct);
+            fileContent.push_back(wordsPunct.at(0));
+
+            if (line[pos] != L',')
+                boundaries->markSentence((uint32_t) fileContent.size());
+        }
+    }
+}
+
+void readAllTexts(const vector<string>& files,
+                  unordered_map <wstring, vector<Word*>> *dictionary,
+                  DocumentTable *documents, const IndexSettings &settings, bool report,
+                  const function<void(uint32_t, const vector<Word*>&, const TextBoundaries&)> &indexDocument) {
+    wstring_convert<codecvt_utf8<wchar_t>> converter;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    // decompression runs on the reader thread, tokenization on this one
+    CorpusReader reader(files);
+    DuplicateDetector duplicates(settings.maxOrder);
+    TextChunk chunk;
+    vector<Word*> fileContent;
+    TextBoundaries boundaries;
+
+    while (reader.next(chunk)) {
+        if (chunk.first) {
+            fileContent.clear();
+            boundaries.clear();
+        }
+
+        auto filePtr = chunk.data;
+        auto lastChar = chunk.data + chunk.length;
+        while (filePtr != lastChar) {
+            auto stringBegin = filePtr;
+            filePtr = static_cast<const char *>(memchr(filePtr, '\n', lastChar - filePtr));
+            if (!filePtr)
+                filePtr = lastChar;
+
+            wstring line = converter.from_bytes(stringBegin, filePtr);
+            tokenizeLine(line, dictionary, fileContent, &boundaries);
+            // every line of an article is a separate paragraph
+            boundaries.markParagraph((uint32_t) fileContent.size());
+
+            if (filePtr != lastChar)
+                filePtr++;
+        }
+
+        if (chunk.last) {
+            if (!settings.filterDuplicates || !duplicates.isDuplicate(fileContent)) {
+                uint32_t docId = documents->add(chunk.docName, (uint32_t) fileContent.size(), boundaries);
+                indexDocument(docId, fileContent, boundaries);
+            }
+            fileContent.clear();
+            boundaries.clear();
+        }
+        CorpusReader::release(chunk);
+    }
+
+    if (!report)
+        return;
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() / 1000.0;
+    double inputMb = reader.compressedBytes / 1048576.0;
+    double textMb = reader.textBytes / 1048576.0;
+    cout << "Read " << reader.documentCount << " documents: " << inputMb << " MB on disk, "
+         << textMb << " MB of text in " << seconds << "[s]";
+    if (seconds > 0)
+        cout << " (" << inputMb / seconds << " MB/s input, " << textMb / seconds << " MB/s text)";
+    cout << endl;
+    if (settings.filterDuplicates)
+        cout << "Near-duplicates removed: " << duplicates.duplicateCount << " documents, "
+             << duplicates.droppedTokens << " tokens, ~" << duplicates.droppedIndexBytes / 1048576.0
+             << " MB of index" << endl;
+}
+
+// Index of the documents one worker has seen, split into partitions by n-gram key
+// so that partitions can be merged independently.
+struct PartialIndex {
+    vector<unordered_map<uint64_t, WordContext*>> partitions;
+    ObjectPool<WordContext> *pool;
+    size_t collisions = 0;
+
+    unordered_map<uint64_t, WordContext*> &partition(uint64_t rawKey) {
+        return partitions[(rawKey >> 32) % partitions.size()];
+    }
+};
+
+struct DocumentJob {
+    uint32_t docId = 0;
+    vector<Word*> content;
+    TextBoundaries boundaries;
+};
+
+// Higher-order n-grams whose document frequency in the pre-pass sketch is below minDf
+// get no context at all. The sketch never underestimates, so only n-grams that exact
+// pruning would drop anyway are skipped; thesaurus n-grams are always kept.
+struct DfFilter {
+    const CountMinSketch *sketch = nullptr;
+    size_t minDf = 1;
+
+    template<class LemmaAt>
+    bool keeps(uint64_t rawKey, int order, LemmaAt lemmaAt, const NGramIndex &index) const {
+        if (!sketch || order == 1 || sketch->estimate(rawKey) >= minDf)
+            return true;
+        return lookupContext(index.phraseContexts, &rawKey, order, lemmaAt) != nullptr;
+    }
+};
+
+// Thesaurus relations of an n-gram. The thesaurus contexts are only read while
+// the index is built, so workers look them up in place.
+template<class LemmaAt>
+static const vector<pair<uint64_t, bool>> *relatedTo(uint64_t rawKey, int order, LemmaAt lemmaAt,
+                                                     const NGramIndex &index) {
+    if (index.relations.empty() || !lookupContext(index.phraseContexts, &rawKey, order, lemmaAt))
+        return nullptr;
+    auto related = index.relations.find(rawKey);
+    return related != index.relations.end() ? &related->second : nullptr;
+}
+
+// Contexts of related n-gram are found through their lemmas, a partial index stores
+// them under its own keys.
+template<class LemmaAt>
+static void addNgramEntryInText(WordContext* ngram, uint64_t rawKey, int order, LemmaAt lemmaAt,
+                                PartialIndex *partial, uint32_t docId, int positiion, const NGramIndex &index) {
+    ngram->entriesIn(docId).push_back(positiion);
+
+    auto related = relatedTo(rawKey, order, lemmaAt, index);
+    if (related) {
+        for (auto &synonimPair : *related) {
+            const WordContext *synonim = index.phraseContexts.at(synonimPair.first);
+            uint64_t synonimKey = ngramKey(synonim->lemmas);
+            findContext(&partial->partition(synonimKey), &synonimKey, (int) synonim->lemmas.size(),
+                        [&](int i) { return synonim->lemmas[i]; }, partial->pool, &partial->collisions)
+                    ->entriesIn(docId);
+        }
+    }
+}
+
+// Emits every n-gram of order 1..window capacity that ends at wordPosition, so a document
+// is scanned once whatever the maximum order is. record gets the raw key, the order,
+// the lemma ids of the n-gram and its start position.
+template<int MaxOrder, class Record>
+static void handleWord(Word* word, NGramWindow<MaxOrder> *window, const int wordPosition,
+                       const TextBoundaries &boundaries, Record &record) {
+    window->push(word);
+
+    uint64_t key = 0;
+    for (int order = 1; order <= window->size(); order++) {
+        auto first = (uint32_t) (wordPosition - order + 1);
+        // n-grams that run across a sentence end are not indexed
+        if (!boundaries.sameSentence(first, wordPosition))
+            break;
+
+        key = prependLemma(key, window->back(order - 1)->lemmaId);
+        record(key, order, [&](int i) {
+            return (uint32_t) window->back(order - 1 - i)->lemmaId;
+        }, (int) first);
+    }
+}
+
+template<int MaxOrder, class Record>
+static void handleFileWindow(const DocumentJob &job, NGramWindow<MaxOrder> window, Record &record) {
+    int wordPosition = 0;
+    for (Word* word : job.content) {
+        handleWord(word, &window, wordPosition, job.boundaries, record);
+        wordPosition++;
+    }
+}
+
+template<class Record>
+static void handleFile(const DocumentJob &job, int maxOrder, Record &record) {
+    // usual orders get a window of compile-time size
+    switch (maxOrder) {
+        case 1:
+            handleFileWindow(job, NGramWindow<1>(), record);
+            break;
+        case 2:
+            handleFileWindow(job, NGramWindow<2>(), record);
+            break;
+        case 3:
+            handleFileWindow(job, NGramWindow<3>(), record);
+            break;
+        default:
+            handleFileWindow(job, NGramWindow<0>(maxOrder), record);
+    }
+}
+
+static void indexInPartial(const DocumentJob &job, PartialIndex *partial, int maxOrder, const DfFilter &filter,
+                           const NGramIndex &index) {
+    auto record = [&](uint64_t key, int order, auto lemmaAt, int position) {
+        if (!filter.keeps(key, order, lemmaAt, index))
+            return;
+        uint64_t storedKey = key;
+        WordContext *ngram = findContext(&partial->partition(key), &storedKey, order, lemmaAt,
+                                         partial->pool, &partial->collisions);
+        addNgramEntryInText(ngram, key, order, lemmaAt, partial, job.docId, position, index);
+    };
+    handleFile(job, maxOrder, record);
+}
+
+// State of one thread that indexes into the shared map.
+struct SharedIndexer {
+    struct Occurrence {
+        WordContext *context;
+        uint64_t rawKey;
+        // -1 for related n-grams, they only get an empty entry
+        int position;
+    };
+
+    ObjectPool<WordContext> *pool = nullptr;
+    unique_ptr<ConcurrentNGramMap::LocalCache> cache = make_unique<ConcurrentNGramMap::LocalCache>();
+    vector<Occurrence> occurrences;
+};
+
+// Occurrences of a document are collected locally and appended to the shared contexts
+// once per n-gram, so even the most frequent n-grams take their stripe lock once per document.
+static void indexInSharedMap(const DocumentJob &job, ConcurrentNGramMap *NGrams, SharedIndexer *indexer,
+                             int maxOrder, const DfFilter &filter, const NGramIndex &index) {
+    auto &occurrences = indexer->occurrences;
+    occurrences.clear();
+
+    auto record = [&](uint64_t key, int order, auto lemmaAt, int position) {
+        if (!filter.keeps(key, order, lemmaAt, index))
+            return;
+        WordContext *ngram = NGrams->findOrAdd(key, order, lemmaAt, indexer->pool, indexer->cache.get());
+        occurrences.push_back({ngram, key, position});
+
+        auto related = relatedTo(key, order, lemmaAt, index);
+        if (related) {
+            for (auto &synonimPair : *related) {
+                const WordContext *synonim = index.phraseContexts.at(synonimPair.first);
+                uint64_t synonimKey = ngramKey(synonim->lemmas);
+                WordContext *synonimNgram = NGrams->findOrAdd(synonimKey, (int) synonim->lemmas.size(),
+                                                              [&](int i) { return synonim->lemmas[i]; },
+                                                              indexer->pool, indexer->cache.get());
+                occurrences.push_back({synonimNgram, synonimKey, -1});
+            }
+        }
+    };
+    handleFile(job, maxOrder, record);
+
+    sort(occurrences.begin(), occurrences.end(), [](const auto &a, const auto &b) {
+        return a.context != b.context ? a.context < b.context : a.position < b.position;
+    });
+    for (size_t begin = 0; begin < occurrences.size();) {
+        size_t end = begin;
+        vector<int> positions;
+        while (end < occurrences.size() && occurrences[end].context == occurrences[begin].context) {
+            if (occurrences[end].position >= 0)
+                positions.push_back(occurrences[end].position);
+            end++;
+        }
+
+        WordContext *context = occurrences[begin].context;
+        NGrams->append(occurrences[begin].rawKey, [&] {
+            context->textEntries.emplace_back(job.docId, std::move(positions));
+        });
+        begin = end;
+    }
+}
+
+// One n-gram occurrence of the sort-based build.
+struct OccurrenceTuple {
+    uint64_t key;
+    uint32_t docId;
+    uint32_t position : 28;
+    uint32_t order : 4;
+};
+
+// what the bit fields of OccurrenceTuple hold
+static constexpr int SORT_MAX_ORDER = 15;
+static constexpr size_t SORT_MAX_TOKENS = (size_t) 1 << 28;
+
+// Sort-based inversion: the occurrences of a run of documents are emitted as tuples
+// into one buffer, radix-sorted by key and turned into postings by a linear scan, so
+// a context is looked up once per n-gram and run instead of once per occurrence.
+// Documents come in order and the sort is stable, so postings stay in document order.
+struct SortInverter {
+    NGramIndex *index;
+    int maxOrder;
+    int threads;
+    size_t runSize;
+    DfFilter filter;
+
+    SortInverter(NGramIndex *index, int maxOrder, int threads, size_t runSize, const DfFilter &filter)
+            : index(index), maxOrder(maxOrder), threads(threads), runSize(runSize), filter(filter) {}
+
+    vector<OccurrenceTuple> tuples;
+    vector<OccurrenceTuple> sortBuffer;
+    // lemma ids of the documents of the run, document docId starts at
+    // documentStarts[docId - firstDocId]
+    vector<uint32_t> lemmaStream;
+    vector<size_t> documentStarts;
+    uint32_t firstDocId = 0;
+
+    const uint32_t *lemmasOf(const OccurrenceTuple &tuple) const {
+        return &lemmaStream[documentStarts[tuple.docId - firstDocId] + tuple.position];
+    }
+};
+
+// Tuples of one raw key are normally one n-gram, n-grams with colliding keys are
+// split off by their lemmas.
+static void appendPostings(const OccurrenceTuple *begin, const OccurrenceTuple *end, SortInverter *inverter) {
+    NGramIndex *index = inverter->index;
+    const uint32_t *lemmas = inverter->lemmasOf(*begin);
+    int order = begin->order;
+    uint64_t key = begin->key;
+    WordContext *context = findContext(&index->phraseContexts, &key, order, [&](int i) { return lemmas[i]; },
+                                       &index->contextPool, &index->collisions);
+
+    vector<OccurrenceTuple> others;
+    for (const OccurrenceTuple *tuple = begin; tuple != end; tuple++) {
+        if (tuple->order == order && equal(lemmas, lemmas + order, inverter->lemmasOf(*tuple)))
+            context->entriesIn(tuple->docId).push_back((int) tuple->position);
+        else
+            others.push_back(*tuple);
+    }
+    if (!others.empty())
+        appendPostings(others.data(), others.data() + others.size(), inverter);
+}
+
+static void flushRun(SortInverter *inverter) {
+    auto &tuples = inverter->tuples;
+    radixSort(&tuples, &inverter->sortBuffer, inverter->threads,
+              [](const OccurrenceTuple &tuple) { return tuple.key; });
+
+    for (size_t begin = 0; begin < tuples.size();) {
+        size_t end = begin + 1;
+        while (end < tuples.size() && tuples[end].key == tuples[begin].key)
+            end++;
+        appendPostings(tuples.data() + begin, tuples.data() + end, inverter);
+        begin = end;
+    }
+
+    tuples.clear();
+    inverter->lemmaStream.clear();
+    inverter->documentStarts.clear();
+}
+
+static void invertDocument(const DocumentJob &job, SortInverter *inverter) {
+    // runs end between documents, a document longer than a run gets a run of its own
+    if (!inverter->tuples.empty() &&
+        inverter->tuples.size() + job.content.size() * inverter->maxOrder > inverter->runSize)
+        flushRun(inverter);
+
+    // document ids are consecutive
+    if (inverter->documentStarts.empty())
+        inverter->firstDocId = job.docId;
+    inverter->documentStarts.push_back(inverter->lemmaStream.size());
+    if (job.content.size() >= SORT_MAX_TOKENS) {
+        cerr << "Document " << job.docId << " has " << job.content.size()
+             << " tokens, too many for the sort-based build, not indexed" << endl;
+        return;
+    }
+    for (Word *word : job.content)
+        inverter->lemmaStream.push_back((uint32_t) word->lemmaId);
+
+    auto record = [&](uint64_t key, int order, auto lemmaAt, int position) {
+        if (inverter->filter.keeps(key, order, lemmaAt, *inverter->index))
+            inverter->tuples.push_back({key, job.docId, (uint32_t) position, (uint32_t) order});
+    };
+    handleFile(job, inverter->maxOrder, record);
+}
+
+// The sort-based build fills postings n-gram by n-gram, so related n-grams get their
+// entries afterwards: one for every document the n-gram itself occurs in.
+static void addRelatedEntries(NGramIndex *index) {
+    auto byDocument = [](const pair<uint32_t, vector<int>> &a, const pair<uint32_t, vector<int>> &b) {
+        return a.first < b.first;
+    };
+
+    for (const auto &relation : index->relations) {
+        vector<uint32_t> docIds;
+        for (const auto &entry : index->phraseContexts.at(relation.first)->textEntries) {
+            // empty entries were added for relations, not for occurrences
+            if (!entry.second.empty())
+                docIds.push_back(entry.first);
+        }
+
+        for (const auto &synonimPair : relation.second) {
+            auto &entries = index->phraseContexts.at(synonimPair.first)->textEntries;
+            size_t own = entries.size();
+            size_t next = 0;
+            for (uint32_t docId : docIds) {
+                while (next < own && entries[next].first < docId)
+                    next++;
+                if (next == own || entries[next].first != docId)
+                    entries.emplace_back(docId, vector<int>());
+            }
+            inplace_merge(entries.begin(), entries.begin() + own, entries.end(), byDocument);
+        }
+    }
+}
+
+// Thesaurus relations by n-gram key. Every related n-gram gets its context up front,
+// so indexing can reach it by key.
+static void resolveRelations(const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                             NGramIndex *index) {
+    auto lemmasOf = [&](const wstring &phrase) {
+        vector<uint32_t> lemmaIds;
+        size_t beg, pos = 0;
+        while ((beg = phrase.find_first_not_of(L' ', pos)) != string::npos) {
+            pos = phrase.find_first_of(L' ', beg + 1);
+            lemmaIds.push_back(index->lemmas.id(phrase.substr(beg, pos - beg)));
+        }
+        return lemmaIds;
+    };
+    auto storedKeyOf = [&](const wstring &phrase) {
+        vector<uint32_t> lemmaIds = lemmasOf(phrase);
+        uint64_t key = ngramKey(lemmaIds);
+        findContext(&index->phraseContexts, &key, (int) lemmaIds.size(), [&](int i) { return lemmaIds[i]; },
+                    &index->contextPool);
+        return key;
+    };
+
+    for (const auto &relation : relations) {
+        auto &related = index->relations[storedKeyOf(relation.first)];
+        for (const auto &synonimPair : relation.second)
+            related.emplace_back(storedKeyOf(synonimPair.first), synonimPair.second);
+    }
+}
+
+// Moves the contexts of one partition of every partial index into merged. Partials are
+// taken in worker order and position lists are put in document order, so the result is
+// the same as the one of a sequential build.
+static void mergePartition(vector<PartialIndex> &partials, size_t partition,
+                           unordered_map<uint64_t, WordContext*> *merged, size_t *collisions) {
+    for (auto &partial : partials) {
+        for (auto &pairContext : partial.partitions[partition]) {
+            WordContext *context = pairContext.second;
+            uint64_t key = ngramKey(context->lemmas);
+            WordContext *target = findContext(merged, &key, (int) context->lemmas.size(),
+                                              [&](int i) { return context->lemmas[i]; }, nullptr, collisions);
+            if (!target) {
+                merged->emplace(key, context);
+                continue;
+            }
+
+            target->textEntries.insert(target->textEntries.end(),
+                                       make_move_iterator(context->textEntries.begin()),
+                                       make_move_iterator(context->textEntries.end()));
+            context->textEntries.clear();
+        }
+        partial.partitions[partition].clear();
+    }
+
+    auto byDocument = [](const pair<uint32_t, vector<int>> &a, const pair<uint32_t, vector<int>> &b) {
+        return a.first < b.first;
+    };
+    for (auto &pairContext : *merged) {
+        auto &entries = pairContext.second->textEntries;
+        if (!is_sorted(entries.begin(), entries.end(), byDocument))
+            sort(entries.begin(), entries.end(), byDocument);
+    }
+}
+
+static void mergePartials(vector<PartialIndex> &partials, int threads, NGramIndex *index) {
+    size_t partitionCount = partials.front().partitions.size();
+    vector<unordered_map<uint64_t, WordContext*>> merged(partitionCount);
+
+    // contexts made for the thesaurus come first, as in a sequential build, and keep
+    // their keys, relations refer to them by key
+    for (auto &pairContext : index->phraseContexts) {
+        uint64_t rawKey = ngramKey(pairContext.second->lemmas);
+        merged[(rawKey >> 32) % partitionCount].emplace(pairContext);
+    }
+
+    vector<size_t> collisions(partitionCount, 0);
+    vector<thread> mergers;
+    for (size_t partition = 0; partition < partitionCount; partition++) {
+        if (threads == 1)
+            mergePartition(partials, partition, &merged[partition], &collisions[partition]);
+        else
+            mergers.emplace_back(mergePartition, ref(partials), partition, &merged[partition], &collisions[partition]);
+    }
+    for (auto &merger : mergers)
+        merger.join();
+
+    for (size_t partition = 0; partition < partitionCount; partition++) {
+        index->collisions += collisions[partition];
+        index->phraseContexts.merge(merged[partition]);
+        // a probed key of one partition can be taken by another one
+        for (auto &pairContext : merged[partition]) {
+            WordContext *context = pairContext.second;
+            uint64_t key = pairContext.first;
+            if (index->phraseContexts.at(key) == context)
+                continue;
+            findContext(&index->phraseContexts, &key, (int) context->lemmas.size(),
+                        [&](int i) { return context->lemmas[i]; }, nullptr, &index->collisions);
+            index->phraseContexts.emplace(key, context);
+        }
+    }
+}
+
+// Workers of the shared map append documents in any order: position lists are sorted
+// in parallel, then the contexts are moved to the index next to the thesaurus ones.
+static void adoptSharedContexts(ConcurrentNGramMap *sharedContexts, int threads, NGramIndex *index) {
+    vector<WordContext*> contexts;
+    sharedContexts->forEach([&](WordContext *context) { contexts.push_back(context); });
+
+    auto byDocument = [](const pair<uint32_t, vector<int>> &a, const pair<uint32_t, vector<int>> &b) {
+        return a.first < b.first;
+    };
+    vector<thread> sorters;
+    for (int sorter = 0; sorter < threads; sorter++) {
+        sorters.emplace_back([&, sorter] {
+            for (size_t i = sorter; i < contexts.size(); i += threads)
+                sort(contexts[i]->textEntries.begin(), contexts[i]->textEntries.end(), byDocument);
+        });
+    }
+    for (auto &sorter : sorters)
+        sorter.join();
+
+    for (WordContext *context : contexts) {
+        uint64_t key = ngramKey(context->lemmas);
+        auto lemmaAt = [&](int i) { return context->lemmas[i]; };
+        WordContext *target = findContext(&index->phraseContexts, &key, (int) context->lemmas.size(), lemmaAt,
+                                          nullptr, &index->collisions);
+        if (target)
+            target->textEntries = std::move(context->textEntries);
+        else
+            index->phraseContexts.emplace(key, context);
+    }
+}
+
+// Drops the n-grams outside the document frequency limits of settings. Single words
+// are never dropped, by document frequency or by top-k, phrase search needs every word.
+// The index is rebuilt from the kept contexts, so no probe chain runs through a
+// dropped key; thesaurus contexts go first and keep their keys, relations refer to them by key.
+static void pruneContexts(const IndexSettings &settings, NGramIndex *index) {
+    size_t maxDf = (size_t) (settings.maxDfRatio * index->documents.size());
+    if (settings.minDf <= 1 && maxDf >= index->documents.size() && settings.topKPerOrder == 0)
+        return;
+
+    unordered_set<uint64_t> thesaurusKeys;
+    for (const auto &relation : index->relations) {
+        thesaurusKeys.insert(relation.first);
+        for (const auto &synonimPair : relation.second)
+            thesaurusKeys.insert(synonimPair.first);
+    }
+
+    unordered_map<uint64_t, WordContext*> kept;
+    vector<vector<WordContext*>> candidates(settings.maxOrder + 1);
+    for (auto &pairContext : index->phraseContexts) {
+        WordContext *context = pairContext.second;
+        size_t df = context->textEntries.size();
+        if (thesaurusKeys.count(pairContext.first))
+            kept.emplace(pairContext);
+        else if (context->lemmas.size() == 1 || (df >= settings.minDf && df <= maxDf))
+            candidates[context->lemmas.size()].push_back(context);
+        else
+            context->textEntries = {};
+    }
+
+    // ties are broken by lemmas, so the kept n-grams do not depend on the build
+    auto moreFrequent = [](const WordContext *a, const WordContext *b) {
+        if (a->textEntries.size() != b->textEntries.size())
+            return a->textEntries.size() > b->textEntries.size();
+        return a->lemmas < b->lemmas;
+    };
+    for (size_t order = 0; order < candidates.size(); order++) {
+        auto &contexts = candidates[order];
+        if (order > 1 && settings.topKPerOrder > 0 && contexts.size() > settings.topKPerOrder) {
+            nth_element(contexts.begin(), contexts.begin() + settings.topKPerOrder, contexts.end(), moreFrequent);
+            for (size_t i = settings.topKPerOrder; i < contexts.size(); i++)
+                contexts[i]->textEntries = {};
+            contexts.resize(settings.topKPerOrder);
+        }
+
+        for (WordContext *context : contexts) {
+            uint64_t key = ngramKey(context->lemmas);
+            findContext(&kept, &key, (int) context->lemmas.size(), [&](int i) { return context->lemmas[i]; },
+                        nullptr);
+            kept.emplace(key, context);
+        }
+    }
+
+    index->pruned += index->phraseContexts.size() - kept.size();
+    index->phraseContexts.swap(kept);
+}
+
+// Streaming pre-pass: the document frequency of every 2..maxOrder-gram goes to the
+// sketch, whose memory does not grow with the corpus. Only lemma ids are kept.
+// Near-duplicates are counted too, that only raises the estimates, and they are
+// detected and reported once, by the indexing pass.
+static void countDocumentFrequencies(const vector<string>& files, unordered_map <wstring, vector<Word*>> *dictionary,
+                                     const IndexSettings &settings, NGramIndex *index, CountMinSketch *sketch) {
+    IndexSettings allDocuments = settings;
+    allDocuments.filterDuplicates = false;
+    DocumentTable documents;
+    DocumentJob job;
+    unordered_set<uint64_t> seen;
+    readAllTexts(files, dictionary, &documents, allDocuments, false,
+                 [&](uint32_t docId, const vector<Word*> &fileContent, const TextBoundaries &boundaries) {
+        for (Word *word : fileContent)
+            index->lemmas.id(word);
+
+        job.docId = docId;
+        job.content = fileContent;
+        job.boundaries = boundaries;
+        seen.clear();
+        auto record = [&](uint64_t key, int order, auto, int) {
+            if (order > 1 && seen.insert(key).second)
+                sketch->add(key);
+        };
+        handleFile(job, settings.maxOrder, record);
+    });
+    cout << "Sketch pre-pass: " << sketch->bytes() / 1048576.0 << " MB" << endl;
+}
+
+void buildIndex(const vector<string>& files,
+                unordered_map <wstring, vector<Word*>> *dictionary,
+                const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                const IndexSettings &requestedSettings, NGramIndex *index) {
+    IndexSettings settings = requestedSettings;
+    settings.maxOrder = max(1, settings.maxOrder);
+    if (settings.buildMode == SORT_BASED && settings.maxOrder > SORT_MAX_ORDER) {
+        cerr << "The sort-based build keeps n-grams up to order " << SORT_MAX_ORDER << ", not "
+             << settings.maxOrder << endl;
+        settings.maxOrder = SORT_MAX_ORDER;
+    }
+    resolveRelations(relations, index);
+
+    unique_ptr<CountMinSketch> sketch;
+    DfFilter filter;
+    if (settings.sketchBytes > 0 && settings.minDf > 1) {
+        sketch = make_unique<CountMinSketch>(settings.sketchBytes, settings.sketchDepth);
+        countDocumentFrequencies(files, dictionary, settings, index, sketch.get());
+        filter = {sketch.get(), settings.minDf};
+    }
+
+    int threads = max(1, settings.threads);
+    IndexBuildMode mode = settings.buildMode;
+    vector<PartialIndex> partials(mode == PARTIAL_INDEXES ? threads : 0);
+    vector<SharedIndexer> sharedIndexers(mode == SHARED_MAP ? threads : 0);
+    ConcurrentNGramMap sharedContexts;
+    for (int worker = 0; worker < threads && mode != SORT_BASED; worker++) {
+        index->partialPools.push_back(make_unique<ObjectPool<WordContext>>());
+        if (mode == SHARED_MAP) {
+            sharedIndexers[worker].pool = index->partialPools.back().get();
+        } else {
+            partials[worker].pool = index->partialPools.back().get();
+            partials[worker].partitions.resize(threads);
+        }
+    }
+    SortInverter inverter(index, settings.maxOrder, threads, settings.sortRunSize, filter);
+
+    auto indexDocument = [&](const DocumentJob &job, int worker) {
+        if (mode == SHARED_MAP)
+            indexInSharedMap(job, &sharedContexts, &sharedIndexers[worker], settings.maxOrder, filter, *index);
+        else if (mode == SORT_BASED)
+            invertDocument(job, &inverter);
+        else
+            indexInPartial(job, &partials[worker], settings.maxOrder, filter, *index);
+    };
+
+    // tuples of the sort-based build are emitted here, its threads sort them
+    bool useWorkers = threads > 1 && mode != SORT_BASED;
+    BlockingQueue<DocumentJob> jobs(64);
+    vector<thread> workers;
+    if (useWorkers) {
+        for (int worker = 0; worker < threads; worker++) {
+            workers.emplace_back([&, worker] {
+                DocumentJob job;
+                while (jobs.pop(job))
+                    indexDocument(job, worker);
+            });
+        }
+    }
+
+    DocumentJob job;
+    vector<uint32_t> lemmaStream, documentStarts;
+    readAllTexts(files, dictionary, &index->documents, settings, true,
+                 [&](uint32_t docId, const vector<Word*> &fileContent, const TextBoundaries &boundaries) {
+        // lemma ids are assigned here, workers only read them
+        for (Word *word : fileContent)
+            index->lemmas.id(word);
+        if (settings.buildSuffixArray || settings.buildFmIndex) {
+            documentStarts.push_back((uint32_t) lemmaStream.size());
+            for (Word *word : fileContent)
+                lemmaStream.push_back((uint32_t) word->lemmaId);
+        }
+
+        job.docId = docId;
+        job.content = fileContent;
+        job.boundaries = boundaries;
+        if (!useWorkers)
+            indexDocument(job, 0);
+        else
+            jobs.push(std::move(job));
+    });
+    jobs.close();
+    for (auto &worker : workers)
+        worker.join();
+
+    if (mode == SHARED_MAP) {
+        index->collisions += sharedContexts.collisions();
+        adoptSharedContexts(&sharedContexts, threads, index);
+    } else if (mode == SORT_BASED) {
+        flushRun(&inverter);
+        addRelatedEntries(index);
+    } else {
+        for (auto &partial : partials)
+            index->collisions += partial.collisions;
+        mergePartials(partials, threads, index);
+    }
+
+    pruneContexts(settings, index);
+
+    double bitmapDf = settings.bitmapDfRatio * index->documents.size();
+    for (auto& pairContext : index->phraseContexts) {
+        uint64_t normalForm = pairContext.first;
+        auto &textEntries = pairContext.second->textEntries;
+        if (!textEntries.empty())
+            index->postings.emplace(normalForm, PostingList(textEntries, textEntries.size() >= bitmapDf));
+        // positions are kept only in the postings
+        pairContext.second->textEntries = {};
+    }
+
+    scorePostingBlocks(index);
+    if (settings.buildImpacts)
+        buildImpactIndex(index);
+    if (settings.championListSize > 0)
+        buildChampionLists(index, settings.championListSize);
+    index->trie.build(index->phraseContexts, index->postings);
+    if (settings.buildSuffixArray)
+        index->suffixArray.build(lemmaStream, documentStarts, threads);
+    if (settings.buildFmIndex) {
+        // the suffix array is only needed to build the FM-index
+        SuffixArray suffixArray;
+        if (!settings.buildSuffixArray)
+            suffixArray.build(lemmaStream, documentStarts, threads);
+        index->fmIndex.build(settings.buildSuffixArray ? index->suffixArray : suffixArray, settings.fmSampleRate);
+    }
+}
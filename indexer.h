@@ -0,0 +1,33 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_INDEXER_H
+#define LABS_INDEXER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "dictionary.h"
+#include "NGramIndex.h"
+
+// Every document is passed to indexDocument as soon as it is tokenized, its token
+// stream is dropped right after that, so only the current document is kept in memory.
+// With report the reading speed and the near-duplicates removed are printed.
+void readAllTexts(const vector<string>& files,
+                  unordered_map <wstring, vector<Word*>> *dictionary,
+                  DocumentTable *documents, const IndexSettings &settings, bool report,
+                  const function<void(uint32_t, const vector<Word*>&, const TextBoundaries&)> &indexDocument);
+
+// Builds the n-gram index of the corpus. With several threads the documents are split
+// between workers with their own partial indexes, which are merged partition by partition,
+// or with one shared map; the sort-based build sorts occurrences with all threads instead.
+// The result does not depend on the build mode or the number of threads, except that the
+// sort-based build caps maxOrder at 15.
+void buildIndex(const vector<string>& files,
+                unordered_map <wstring, vector<Word*>> *dictionary,
+                const unordered_map<wstring, vector<pair<wstring, bool>>> &relations,
+                const IndexSettings &settings, NGramIndex *index);
+
+#endif //LABS_INDEXER_H
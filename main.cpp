@@ -8,16 +8,18 @@
 #include "dictionary.h"
 #include "filemap.h"
 #include "WordContext.h"
-#include "Entry.h"
 #include "json.hpp"
+#include "NGramIndex.h"
+#include "NGramKey.h"
+#include "indexer.h"
+#include "benchmarks.h"
+#include "search.h"
 #include <chrono>
+#include <cmath>
 
 using namespace std;
 using recursive_directory_iterator = std::__fs::filesystem::recursive_directory_iterator;
 
-double K1 = 2;
-double B = 0.75;
-
 vector<string> getFilesFromDir(const string& dirPath) {
     vector<string> files;
     for (const auto& dirEntry : recursive_directory_iterator(dirPath))
@@ -26,216 +28,33 @@ vector<string> getFilesFromDir(const string& dirPath) {
     return files;
 }
 
-WordContext* processContext(const vector<Word*>& wordVector, int windowSize,
-                            unordered_map <wstring, WordContext*> *NGrams) {
-    wstring normalizedForm;
-    normalizedForm.reserve(windowSize * 8);
-
-    vector<Word*> contextVector;
-    for (int i = 0; i < windowSize; i++) {
-        Word* word = wordVector[i];
-        contextVector.push_back(word);
-        normalizedForm += word->word + L' ';
-    }
-    normalizedForm.pop_back();
-
-    return new WordContext(normalizedForm);
-}
-
-void addNgramEntryInText(WordContext* context,
-                         unordered_map <wstring, WordContext*>* NGramms,
-                         const string& filePath, int positiion,
-                         unordered_map<wstring, vector<pair<wstring, bool>>> &relations) {
-    wstring nornalForm = context->normalizedForm;
-    if (NGramms->find(nornalForm) == NGramms->end())
-        NGramms->emplace(nornalForm, context);
-
-    auto &ngram= NGramms->at(nornalForm);
-    if (ngram->textEntries.find(filePath) == ngram->textEntries.end())
-        ngram->textEntries.emplace(filePath, vector<int>{});
-
-    ngram->textEntries.at(filePath).push_back(positiion);
-
-    if (relations.find(nornalForm) != relations.end()) {
-        for (auto &synonimPair : relations[nornalForm]) {
-            wstring synonim = synonimPair.first;
-            auto* synonimContext = new WordContext(synonim);
-            if (NGramms->find(synonim) == NGramms->end())
-                NGramms->emplace(synonim, synonimContext);
-
-            auto &synonimNgram= NGramms->at(synonim);
-            if (synonimNgram->textEntries.find(filePath) == synonimNgram->textEntries.end())
-                synonimNgram->textEntries.emplace(filePath, vector<int>{});
-        }
-    }
-}
-
-void handleWord(Word* word,
-                vector<Word*>* leftWordContext,
-                unordered_map <wstring, WordContext*> *NGrams,
-                int windowSize, const string& filePath,
-                const int wordPosition,
-                unordered_map<wstring, vector<pair<wstring, bool>>> &relations) {
-    if (windowSize <= leftWordContext->size()) {
-        WordContext* phraseContext = processContext(*leftWordContext, windowSize, NGrams);
-        addNgramEntryInText(phraseContext, NGrams, filePath, wordPosition, relations);
-    }
-
-    if (leftWordContext->size() == (windowSize + 1)) {
-        leftWordContext->erase(leftWordContext->begin());
-    }
-
-    leftWordContext->push_back(word);
-}
-
-void handleFile(const string& filepath, const vector<Word*>& fileContent,
-                unordered_map <wstring, vector<Word*>> *dictionary,
-                unordered_map <wstring, WordContext*> *NGrams,
-                int windowSize, unordered_map<wstring, vector<pair<wstring, bool>>> &relations) {
-    vector<Word*> leftWordContext;
-
-    int wordPosition = 0;
-    for (Word* word : fileContent) {
-        handleWord(word,&leftWordContext,
-                   NGrams, windowSize, filepath, wordPosition, relations);
-        wordPosition++;
-    }
-}
-
-unordered_map <string, vector<Word*>> readAllTexts(const vector<string>& files,
-                                                   unordered_map <wstring, vector<Word*>> *dictionary,
-                                                   double *averageLength) {
-    auto &f = std::use_facet<std::ctype<wchar_t>>(std::locale());
-    unordered_map <string, vector<Word*>> fileContents;
-    vector<wstring> leftStringNGrams;
-
-    *averageLength = 0;
-    for (const auto& filepath : files) {
-        fileContents.emplace(filepath, vector<Word *>{});
-        vector<Word*> fileContent = fileContents.at(filepath);
-
-        size_t length;
-        auto filePtr = map_file(filepath.c_str(), length);
-        auto firstChar = filePtr;
-        auto lastChar = filePtr + length;
-
-        while (filePtr && filePtr != lastChar) {
-            auto stringBegin = filePtr;
-            filePtr = static_cast<char *>(memchr(filePtr, '\n', lastChar - filePtr));
-
-            wstring line = wstring_convert<codecvt_utf8<wchar_t>>().from_bytes(stringBegin, filePtr);
-            wstring const delims{L" :;.,!?() \r\n"};
-
-            size_t beg, pos = 0;
-            while ((beg = line.find_first_not_of(delims, pos)) != string::npos) {
-                pos = line.find_first_of(delims, beg + 1);
-                wstring wordStr = line.substr(beg, pos - beg);
-
-                f.toupper(&wordStr[0], &wordStr[0] + wordStr.size());
-
-                if (dictionary->find(wordStr) == dictionary->end()) {
-                    Word *newWord = new Word();
-                    newWord->word = wordStr;
-                    newWord->partOfSpeech = L"UNKW";
-                    dictionary->emplace(newWord->word, vector<Word *>{newWord});
-                }
-
-                vector<Word *> &words = dictionary->at(wordStr);
-                fileContent.push_back(words.at(0));
-
-                if (line[pos] == L'.' || line[pos] == L',' ||
-                    line[pos] == L'!' || line[pos] == L'?') {
-                    wstring punct;
-                    punct.push_back(line[pos]);
-                    if (dictionary->find(punct) == dictionary->end()) {
-                        Word *newWord = new Word();
-                        newWord->word = punct;
-                        newWord->partOfSpeech = L"UNKW";
-                        dictionary->emplace(newWord->word, vector<Word *>{newWord});
-                    }
-
-                    vector<Word *> &wordsPunct = dictionary->at(punct);
-                    fileContent.push_back(wordsPunct.at(0));
-                }
-            }
-            if (filePtr)
-                filePtr++;
-        }
-        munmap(firstChar, length);
-        fileContents.at(filepath) = fileContent;
-        *averageLength += fileContent.size();
-    }
-    *averageLength /= (double) fileContents.size();
-    return fileContents;
-}
-
-void handleRequest(unordered_map<wstring, vector<Entry*>> &phraseDescriptions,
-                   unordered_map <wstring, vector<Word*>> *dictionary,
-                   const wstring& request, const unordered_map <string, vector<Word*>>& filesContent,
-                   double averageLength, unordered_map<wstring, vector<pair<wstring, bool>>> &relations) {
-    auto &f = std::use_facet<std::ctype<wchar_t>>(std::locale());
-
-    vector<wstring> requestWords;
-    size_t beg, pos = 0;
-    while ((beg = request.find_first_not_of(' ', pos)) != string::npos) {
-        pos = request.find_first_of(' ', beg + 1);
-        wstring wordStr = request.substr(beg, pos - beg);
-        f.toupper(&wordStr[0], &wordStr[0] + wordStr.size());
-
-        if (dictionary->find(wordStr) == dictionary->end()) {
-            Word *newWord = new Word();
-            newWord->word = wordStr;
-            newWord->partOfSpeech = L"UNKW";
-            dictionary->emplace(newWord->word, vector<Word*> {newWord});
-        }
-
-        vector<Word *> &words = dictionary->at(wordStr);
-        wstring normalForm = words.at(0)->word;
-
-        requestWords.push_back(normalForm);
-    }
+void handleRequest(NGramIndex &index, unordered_map <wstring, vector<Word*>> *dictionary,
+                   const wstring& request) {
+    const auto &postings = index.postings;
+    auto &phraseContexts = index.phraseContexts;
+    auto &lemmas = index.lemmas;
+    const auto &documents = index.documents;
 
-    vector<pair<string, double>> filenameToScore;
-    for (const auto& filepair : filesContent) {
-        string filename = filepair.first;
-        auto fileContent = filepair.second;
-        int fileSize = fileContent.size();
-        double score = 0;
-        for (const auto& requestWord : requestWords) {
-            if (phraseDescriptions.find(requestWord) != phraseDescriptions.end()) {
-                auto description  = phraseDescriptions.find(requestWord);
-                for (auto &word: description->second) {
-                    if (word->docName == filename) {
-                        score += word->idf * (word->tf * (K1 + 1)) / (word->tf + K1 * (1 - B + B * fileSize / averageLength));
-                    }
-                }
-                if (relations.find(requestWord) != relations.end()) {
-                    auto wordsToHandle = relations[requestWord];
-                    for (const auto& requestWordSynonim : wordsToHandle) {
-                        if (phraseDescriptions.find(requestWordSynonim.first) != phraseDescriptions.end()) {
-                            auto descriptionSynonim  = phraseDescriptions.find(requestWordSynonim.first);
-                            for (auto &word: descriptionSynonim->second) {
-                                if (word->docName == filename) {
-                                    if (requestWordSynonim.second)
-                                        score += 0.9 * word->idf * (word->tf * (K1 + 1)) / (word->tf + K1 * (1 - B + B * fileSize / averageLength));
-                                    else
-                                        score += 0.6 * word->idf * (word->tf * (K1 + 1)) / (word->tf + K1 * (1 - B + B * fileSize / averageLength));
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        filenameToScore.emplace_back(filename, score);
+    vector<uint64_t> requestWords = requestTerms(index, dictionary, request);
+    int OUTPUT_COUNT = 10;
+    vector<pair<uint32_t, double>> filenameToScore;
+    if (!index.champions.empty())
+        filenameToScore = rankByChampions(index, requestWords, OUTPUT_COUNT);
+    else if (index.impacts.size() > 0)
+        filenameToScore = rankByImpact(index, requestWords, OUTPUT_COUNT);
+    else
+        filenameToScore = rankDocuments(index, requestWords);
+    vector<vector<uint32_t>> phrases = requestPhrases(index, dictionary, request);
+    vector<vector<pair<uint32_t, uint32_t>>> phraseMatches;
+    for (const auto &phrase : phrases) {
+        if (index.fmIndex.size() > 0)
+            phraseMatches.push_back(index.fmIndex.occurrences(phrase.data(), phrase.size(), documents));
+        else if (index.suffixArray.size() > 0)
+            phraseMatches.push_back(index.suffixArray.occurrences(phrase.data(), phrase.size(), documents));
+        else
+            phraseMatches.push_back(matchPhrase(index, phrase));
     }
 
-    struct {
-        bool operator()(const pair<string, double>& a, const pair<string, double>& b) const { return a.second > b.second; }
-    } compDescription;
-    sort(filenameToScore.begin(), filenameToScore.end(), compDescription);
-
-    int OUTPUT_COUNT = 10;
     int count = 0;
     for (const auto& scorePair : filenameToScore) {
         if (count == OUTPUT_COUNT)
@@ -243,88 +62,79 @@ void handleRequest(unordered_map<wstring, vector<Entry*>> &phraseDescriptions,
         count++;
 
         if (scorePair.second > 0) {
-            string filename = scorePair.first;
-            string filenameShort = scorePair.first;
-            cout << "Result " << count << " | " << filenameShort.replace(0, 57, "") << " | Score: " << scorePair.second << " | File size: " << filesContent.at(filename).size() << endl;
+            uint32_t docId = scorePair.first;
+            string filenameShort = documents.name(docId);
+            cout << "Result " << count << " | " << filenameShort.replace(0, 57, "") << " | Score: " << scorePair.second << " | File size: " << documents.length(docId) << endl;
             for (const auto& requestWord : requestWords) {
-                if (phraseDescriptions.find(requestWord) != phraseDescriptions.end()) {
-                    auto description = phraseDescriptions.find(requestWord);
-                    for (auto &word: description->second) {
-                        if (word->docName == filename) {
-                            wcout << " - " << requestWord << " - Count: " << word->positions.size() << ", TF: " << word->tf << ", IDF: " << word->idf << " | Entry" << endl;
-                        }
+                if (postings.find(requestWord) != postings.end()) {
+                    const PostingList &list = postings.at(requestWord);
+                    uint32_t wordCount;
+                    if (list.find(docId, &wordCount)) {
+                        double tf = (double) wordCount / documents.length(docId);
+                        double idf = log10((double) documents.size() / (double) list.size());
+                        wcout << " - " << lemmas.text(phraseContexts.at(requestWord)->lemmas) << " - Count: " << wordCount << ", TF: " << tf << ", IDF: " << idf << " | Entry" << endl;
                     }
                 }
-                if (relations.find(requestWord) != relations.end()) {
-                    auto wordsToHandle = relations[requestWord];
+                auto related = index.relations.find(requestWord);
+                if (related != index.relations.end()) {
+                    auto &wordsToHandle = related->second;
                     for (const auto& requestWordSynonim : wordsToHandle) {
-                        if (phraseDescriptions.find(requestWordSynonim.first) != phraseDescriptions.end()) {
-                            auto descriptionSynonim  = phraseDescriptions.find(requestWordSynonim.first);
-                            for (auto &word: descriptionSynonim->second) {
-                                if (word->docName == filename && !word->positions.empty()) {
-                                    wcout << "    - " << requestWordSynonim.first << " - Count: " << word->positions.size() << ", TF: " << word->tf << ", IDF: " << word->idf << " | ";
-                                    if (requestWordSynonim.second)
-                                        cout << "Synonim" << endl;
-                                    else
-                                        cout << "Up/Down" << endl;
-                                }
+                        if (postings.find(requestWordSynonim.first) != postings.end()) {
+                            const PostingList &list = postings.at(requestWordSynonim.first);
+                            uint32_t wordCount;
+                            if (list.find(docId, &wordCount) && wordCount > 0) {
+                                double tf = (double) wordCount / documents.length(docId);
+                                double idf = log10((double) documents.size() / (double) list.size());
+                                wcout << "    - " << lemmas.text(phraseContexts.at(requestWordSynonim.first)->lemmas) << " - Count: " << wordCount << ", TF: " << tf << ", IDF: " << idf << " | ";
+                                if (requestWordSynonim.second)
+                                    cout << "Synonim" << endl;
+                                else
+                                    cout << "Up/Down" << endl;
                             }
                         }
                     }
                 }
             }
+            // quoted phrases of any length, matched word by word
+            for (size_t i = 0; i < phrases.size(); i++) {
+                auto found = lower_bound(phraseMatches[i].begin(), phraseMatches[i].end(), make_pair(docId, (uint32_t) 0));
+                if (found != phraseMatches[i].end() && found->first == docId)
+                    wcout << " - " << lemmas.text(phrases[i]) << " - Count: " << found->second << " | Phrase" << endl;
+            }
         }
     }
 }
 
 void findTexts(const string& dictPath, const string& corpusPath,
-               unordered_map<wstring, vector<pair<wstring, bool>>> &relations, vector<wstring> &requests) {
+               unordered_map<wstring, vector<pair<wstring, bool>>> &relations, vector<wstring> &requests,
+               const IndexSettings &settings) {
     auto dictionary = initDictionary(dictPath);
     vector<string> files = getFilesFromDir(corpusPath);
 
-    unordered_map<wstring, WordContext *> phraseContexts;
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
-    double averageLength;
-    unordered_map <string, vector<Word*>> filesContent = readAllTexts(files, &dictionary, &averageLength);
-
-    int windowSize = 1;
-    while (true) {
-        for (const string &filepath: files) {
-            handleFile(filepath, filesContent.at(filepath), &dictionary,
-                       &phraseContexts, windowSize, relations);
-        }
-
-        windowSize++;
-        if (phraseContexts.empty() || windowSize == 4)
-            break;
-    }
-
-    unordered_map<wstring, vector<Entry*>> phraseDescriptions;
-
-    for (auto& pairContext : phraseContexts) {
-        wstring normalForm = pairContext.first;
-        for (auto &entry : pairContext.second->textEntries) {
-            string filename = entry.first;
-
-            if (phraseDescriptions.find(normalForm) == phraseDescriptions.end())
-                phraseDescriptions.emplace(normalForm, vector<Entry*>{});
-
-            double tf = (double) entry.second.size() / filesContent.at(filename).size();
-            double idf = log10((double) files.size() / (double) pairContext.second->textEntries.size());
-
-            auto phraseEntry = new Entry(filename, tf, idf, entry.second);
-            phraseDescriptions.at(normalForm).push_back(phraseEntry);
-        }
-    }
+    NGramIndex index;
+    buildIndex(files, &dictionary, relations, settings, &index);
 
     std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
     std::cout << "\nIndexation time = " << std::chrono::duration_cast<std::chrono::seconds>(end - begin).count() << "[s]" << std::endl;
+    std::cout << "N-grams indexed: " << index.phraseContexts.size() << ", pruned: " << index.pruned
+              << ", key collisions: " << index.collisions << std::endl;
+    std::cout << "N-gram trie: " << index.trie.size() << " nodes, " << index.trie.bytes() / 1048576.0 << " MB" << std::endl;
+    if (index.suffixArray.size() > 0)
+        std::cout << "Suffix array: " << index.suffixArray.size() << " suffixes, " << index.suffixArray.bytes() / 1048576.0 << " MB" << std::endl;
+    if (index.fmIndex.size() > 0)
+        std::cout << "FM-index: " << index.fmIndex.size() << " symbols, " << index.fmIndex.bytes() / 1048576.0 << " MB" << std::endl;
+    if (index.impacts.size() > 0)
+        std::cout << "Impacts: " << index.impacts.size() << " n-grams, " << index.impacts.bytes() / 1048576.0 << " MB" << std::endl;
+    std::cout << "Index memory: " << index.bytes() / 1048576.0 << " MB, postings " << index.postingBytes() / 1048576.0
+              << " MB, n-gram contexts " << index.contextBytes() / 1048576.0 << " MB" << std::endl;
+    std::cout << "Peak RSS: " << peakMemoryMb() << " MB" << std::endl;
 
     int requestNumber = 1;
     for (const wstring& request : requests) {
         wcout << endl << "Request " << requestNumber++ << ": " << request << endl;
-        handleRequest(phraseDescriptions, &dictionary, request, filesContent, averageLength, relations);
+        handleRequest(index, &dictionary, request);
     }
 }
 
@@ -383,7 +193,38 @@ void loadRequests(const string& requestsPath, vector<wstring> &requests) {
     }
 }
 
-int main() {
+static void printUsage() {
+    cout << "Options, each followed by its value:\n"
+            "  --build-mode partial|shared|sort  how the n-gram index is built\n"
+            "  --max-order N                     longest n-gram, at most 15 with sort\n"
+            "  --dedup on|off                    drop near-duplicate documents (on)\n"
+            "  --min-df N, --max-df R, --top-k N prune n-grams of 2 and more words\n"
+            "  --sketch-mb M                     count-min pre-pass for --min-df\n"
+            "  --suffix-array on|off             suffix array for quoted phrases\n"
+            "  --fm-index on|off                 FM-index for quoted phrases, built in\n"
+            "                                    addition to the postings, not instead\n"
+            "  --fm-sample N                     FM-index position sample rate\n"
+            "  --impacts on|off                  rank by quantized BM25 impacts\n"
+            "  --champions N                     rank by champion lists of N documents\n"
+            "Benchmarks: --bench-window, --bench-concurrent-map, --bench-build, --bench-trie,\n"
+            "  --bench-postings, --bench-phrases, --bench-suffix-array, --bench-fm-index,\n"
+            "  --bench-bitmaps, --bench-impacts, --bench-block-max, --bench-champions,\n"
+            "  --bench-pruning" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && string(argv[1]) == "--help") {
+        printUsage();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-window") {
+        benchmarkWindow();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-concurrent-map") {
+        benchmarkConcurrentMap();
+        return 0;
+    }
 
     locale::global(locale("ru_RU.UTF-8"));
     wcout.imbue(locale("ru_RU.UTF-8"));
@@ -399,6 +240,96 @@ int main() {
     unordered_map<wstring, vector<pair<wstring, bool>>> relations;
     loadTesaurus(tesaurusPath, relations);
 
-    findTexts(dictPath, corpusPath, relations, requests);
+    IndexSettings settings;
+    for (int i = 1; i + 1 < argc; i++) {
+        string option = argv[i];
+        string value = argv[i + 1];
+        if (option == "--build-mode") {
+            if (value == "shared")
+                settings.buildMode = SHARED_MAP;
+            else if (value == "sort")
+                settings.buildMode = SORT_BASED;
+        } else if (option == "--max-order") {
+            settings.maxOrder = max(1, stoi(value));
+        } else if (option == "--dedup") {
+            settings.filterDuplicates = value == "on";
+        } else if (option == "--min-df") {
+            settings.minDf = stoul(value);
+        } else if (option == "--max-df") {
+            settings.maxDfRatio = stod(value);
+        } else if (option == "--top-k") {
+            settings.topKPerOrder = stoul(value);
+        } else if (option == "--sketch-mb") {
+            settings.sketchBytes = (size_t) (stod(value) * 1048576);
+        } else if (option == "--suffix-array") {
+            settings.buildSuffixArray = value == "on";
+        } else if (option == "--fm-index") {
+            settings.buildFmIndex = value == "on";
+        } else if (option == "--fm-sample") {
+            settings.fmSampleRate = (uint32_t) max(1, stoi(value));
+        } else if (option == "--impacts") {
+            settings.buildImpacts = value == "on";
+        } else if (option == "--champions") {
+            settings.championListSize = stoul(value);
+        }
+    }
+
+    if (argc > 1 && string(argv[1]) == "--bench-build") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkBuild(getFilesFromDir(corpusPath), &dictionary, relations, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-trie") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkTrie(getFilesFromDir(corpusPath), &dictionary, relations, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-postings") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkPostings(getFilesFromDir(corpusPath), &dictionary, relations, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-phrases") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkPhrases(getFilesFromDir(corpusPath), &dictionary, relations, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-suffix-array") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkSuffixArray(getFilesFromDir(corpusPath), &dictionary, relations, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-fm-index") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkFmIndex(getFilesFromDir(corpusPath), &dictionary, relations, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-bitmaps") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkBitmaps(getFilesFromDir(corpusPath), &dictionary, relations, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-impacts") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkImpacts(getFilesFromDir(corpusPath), &dictionary, relations, requests, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-block-max") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkBlockMax(getFilesFromDir(corpusPath), &dictionary, relations, requests, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-champions") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkChampions(getFilesFromDir(corpusPath), &dictionary, relations, requests, settings);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-pruning") {
+        auto dictionary = initDictionary(dictPath);
+        benchmarkPruning(getFilesFromDir(corpusPath), &dictionary, relations, requests, settings);
+        return 0;
+    }
+
+    findTexts(dictPath, corpusPath, relations, requests, settings);
     return 0;
 }
@@ -0,0 +1,491 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "search.h"
+#include "NGramKey.h"
+
+#include <algorithm>
+#include <cmath>
+#include <locale>
+
+double K1 = 2;
+double B = 0.75;
+
+static uint32_t requestLemma(NGramIndex &index, unordered_map<wstring, vector<Word*>> *dictionary,
+                             wstring wordStr) {
+    auto &f = std::use_facet<std::ctype<wchar_t>>(std::locale());
+    f.toupper(&wordStr[0], &wordStr[0] + wordStr.size());
+
+    if (dictionary->find(wordStr) == dictionary->end()) {
+        Word *newWord = new Word();
+        newWord->word = wordStr;
+        newWord->partOfSpeech = L"UNKW";
+        dictionary->emplace(newWord->word, vector<Word*> {newWord});
+    }
+
+    vector<Word *> &words = dictionary->at(wordStr);
+    return index.lemmas.id(words.at(0));
+}
+
+// A quoted phrase is split into the longest indexed n-grams, one trie walk per n-gram.
+static void addPhraseTerms(const NGramIndex &index, const vector<uint32_t> &lemmaIds, vector<uint64_t> *terms) {
+    size_t begin = 0;
+    while (begin < lemmaIds.size()) {
+        uint64_t key;
+        int order = index.trie.longestMatch(&lemmaIds[begin], (int) (lemmaIds.size() - begin), &key);
+        if (order == 0) {
+            begin++;
+            continue;
+        }
+        terms->push_back(key);
+        begin += order;
+    }
+}
+
+// Lemma ids of the request in groups: a quoted phrase is one group, every other word
+// is a group of its own. The flag tells quoted groups apart.
+static vector<pair<vector<uint32_t>, bool>> splitRequest(NGramIndex &index,
+                                                         unordered_map<wstring, vector<Word*>> *dictionary,
+                                                         const wstring &request) {
+    wstring const delims{L" \"«»"};
+
+    vector<pair<vector<uint32_t>, bool>> groups;
+    vector<uint32_t> phrase;
+    bool quoted = false;
+    size_t pos = 0;
+    while (pos < request.size()) {
+        if (request[pos] == L'"' || request[pos] == L'«' || request[pos] == L'»') {
+            if (quoted && !phrase.empty())
+                groups.emplace_back(phrase, true);
+            phrase.clear();
+            quoted = request[pos] == L'«' || (request[pos] == L'"' && !quoted);
+            pos++;
+            continue;
+        }
+
+        size_t beg = request.find_first_not_of(L' ', pos);
+        if (beg == string::npos)
+            break;
+        if (delims.find(request[beg]) != wstring::npos) {
+            pos = beg;
+            continue;
+        }
+        pos = min(request.find_first_of(delims, beg + 1), request.size());
+
+        phrase.push_back(requestLemma(index, dictionary, request.substr(beg, pos - beg)));
+        if (!quoted) {
+            groups.emplace_back(phrase, false);
+            phrase.clear();
+        }
+    }
+    // an unclosed quote runs to the end of the request
+    if (!phrase.empty())
+        groups.emplace_back(phrase, true);
+    return groups;
+}
+
+vector<uint64_t> requestTerms(NGramIndex &index, unordered_map<wstring, vector<Word*>> *dictionary,
+                              const wstring &request) {
+    vector<uint64_t> requestWords;
+    for (const auto &group : splitRequest(index, dictionary, request))
+        addPhraseTerms(index, group.first, &requestWords);
+    return requestWords;
+}
+
+vector<vector<uint32_t>> requestPhrases(NGramIndex &index, unordered_map<wstring, vector<Word*>> *dictionary,
+                                        const wstring &request) {
+    vector<vector<uint32_t>> phrases;
+    for (auto &group : splitRequest(index, dictionary, request))
+        if (group.second)
+            phrases.push_back(std::move(group.first));
+    return phrases;
+}
+
+// Number of chains of positions[0][a] < positions[1][b] < ... that start in the document,
+// each step at most slop + 1 words long and the whole chain inside one sentence.
+// The earliest next position is always the best one, so every start is checked greedily.
+static uint32_t countPhrase(const DocumentTable &documents, uint32_t docId, const vector<const int*> &positions,
+                            const vector<uint32_t> &counts, int slop) {
+    vector<uint32_t> from(positions.size(), 0);
+    uint32_t matches = 0;
+    for (uint32_t start = 0; start < counts[0]; start++) {
+        int previous = positions[0][start];
+        size_t term = 1;
+        for (; term < positions.size(); term++) {
+            const int *next = gallop(positions[term] + from[term], positions[term] + counts[term],
+                                     previous + 1, less<int>());
+            from[term] = (uint32_t) (next - positions[term]);
+            // later starts find nothing either
+            if (from[term] == counts[term])
+                return matches;
+            if (*next > previous + 1 + slop)
+                break;
+            previous = *next;
+        }
+        if (term == positions.size() && documents.sameSentence(docId, positions[0][start], previous))
+            matches++;
+    }
+    return matches;
+}
+
+vector<pair<uint32_t, uint32_t>> matchPhrase(const NGramIndex &index, const vector<uint32_t> &lemmaIds, int slop) {
+    vector<const PostingList*> lists;
+    for (uint32_t lemmaId : lemmaIds) {
+        uint64_t key;
+        if (index.trie.longestMatch(&lemmaId, 1, &key) == 0)
+            return {};
+        auto found = index.postings.find(key);
+        if (found == index.postings.end())
+            return {};
+        lists.push_back(&found->second);
+    }
+
+    // the two rarest words are intersected as bitmaps or lists, the rest are checked
+    // by cursors on the documents both have
+    vector<size_t> byFrequency(lists.size());
+    for (size_t i = 0; i < lists.size(); i++)
+        byFrequency[i] = i;
+    sort(byFrequency.begin(), byFrequency.end(), [&](size_t a, size_t b) { return lists[a]->size() < lists[b]->size(); });
+    vector<uint32_t> candidates = lists.size() == 1 ? lists[0]->documentIds() :
+                                  intersectDocuments(*lists[byFrequency[0]], *lists[byFrequency[1]]).toVector();
+
+    vector<PostingCursor> cursors;
+    for (const PostingList *list : lists)
+        cursors.emplace_back(*list);
+    vector<pair<uint32_t, uint32_t>> documents;
+    vector<const int*> positions(cursors.size());
+    vector<uint32_t> counts(cursors.size());
+    for (uint32_t docId : candidates) {
+        bool everywhere = true;
+        for (size_t i = 0; i < cursors.size() && everywhere; i++) {
+            if (!cursors[byFrequency[i]].advance(docId))
+                return documents;
+            everywhere = cursors[byFrequency[i]].docId() == docId;
+        }
+        if (!everywhere)
+            continue;
+
+        // every word is in the document, now the positions
+        for (size_t i = 0; i < cursors.size(); i++) {
+            positions[i] = cursors[i].positions();
+            counts[i] = cursors[i].count();
+        }
+        uint32_t matches = countPhrase(index.documents, docId, positions, counts, slop);
+        if (matches > 0)
+            documents.emplace_back(docId, matches);
+    }
+    return documents;
+}
+
+vector<pair<uint32_t, double>> rankDocuments(const NGramIndex &index, const vector<uint64_t> &requestWords) {
+    const auto &documents = index.documents;
+    double averageLength = documents.averageLength();
+
+    // term at a time, one linear pass over the decoded blocks of every term and relation
+    // in request order, so every document sums its terms in request order
+    vector<double> scores(documents.size(), 0);
+    uint32_t docIds[PostingList::BLOCK_SIZE], counts[PostingList::BLOCK_SIZE];
+    auto addTerm = [&](uint64_t key, double weight) {
+        auto found = index.postings.find(key);
+        if (found == index.postings.end())
+            return;
+        const PostingList &list = found->second;
+        double idf = log10((double) documents.size() / (double) list.size());
+        for (size_t block = 0; block < list.blockCount(); block++) {
+            size_t count = list.decodeBlock(block, docIds, counts);
+            for (size_t i = 0; i < count; i++) {
+                uint32_t docId = docIds[i];
+                int fileSize = documents.length(docId);
+                double tf = (double) counts[i] / documents.length(docId);
+                scores[docId] += weight * idf * (tf * (K1 + 1)) / (tf + K1 * (1 - B + B * fileSize / averageLength));
+            }
+        }
+    };
+    for (const auto& requestWord : requestWords) {
+        if (index.postings.find(requestWord) == index.postings.end())
+            continue;
+        addTerm(requestWord, 1.0);
+
+        auto related = index.relations.find(requestWord);
+        if (related != index.relations.end()) {
+            for (const auto& requestWordSynonim : related->second)
+                addTerm(requestWordSynonim.first, requestWordSynonim.second ? 0.9 : 0.6);
+        }
+    }
+
+    vector<pair<uint32_t, double>> filenameToScore;
+    for (uint32_t docId = 0; docId < scores.size(); docId++)
+        filenameToScore.emplace_back(docId, scores[docId]);
+
+    struct {
+        bool operator()(const pair<uint32_t, double>& a, const pair<uint32_t, double>& b) const { return a.second > b.second; }
+    } compDescription;
+    sort(filenameToScore.begin(), filenameToScore.end(), compDescription);
+    return filenameToScore;
+}
+
+double postingScore(const DocumentTable &documents, double averageLength, uint32_t docId, uint32_t count,
+                    size_t df) {
+    int fileSize = documents.length(docId);
+    double tf = (double) count / fileSize;
+    double idf = log10((double) documents.size() / (double) df);
+    return idf * (tf * (K1 + 1)) / (tf + K1 * (1 - B + B * fileSize / averageLength));
+}
+
+void scorePostingBlocks(NGramIndex *index) {
+    const auto &documents = index->documents;
+    double averageLength = documents.averageLength();
+    for (auto &pairPostings : index->postings) {
+        size_t df = pairPostings.second.size();
+        pairPostings.second.computeBlockMaxScores([&](uint32_t docId, uint32_t count) {
+            return postingScore(documents, averageLength, docId, count, df);
+        });
+    }
+}
+
+void buildImpactIndex(NGramIndex *index) {
+    const auto &documents = index->documents;
+    double averageLength = documents.averageLength();
+    index->impacts.build(index->postings, [&](uint32_t docId, uint32_t count, size_t df) {
+        return postingScore(documents, averageLength, docId, count, df);
+    });
+}
+
+vector<pair<uint32_t, double>> rankByImpact(const NGramIndex &index, const vector<uint64_t> &requestWords,
+                                            size_t topK, bool earlyTermination, size_t *processed) {
+    // the same terms and relation weights as rankDocuments
+    vector<const ImpactIndex::ImpactList*> lists;
+    vector<const PostingList*> postingLists;
+    vector<double> weights;
+    auto addTerm = [&](uint64_t key, double weight) {
+        const ImpactIndex::ImpactList *list = index.impacts.find(key);
+        if (list == nullptr)
+            return;
+        lists.push_back(list);
+        postingLists.push_back(&index.postings.at(key));
+        weights.push_back(weight);
+    };
+    for (const auto &requestWord : requestWords) {
+        if (index.impacts.find(requestWord) == nullptr)
+            continue;
+        addTerm(requestWord, 1.0);
+
+        auto related = index.relations.find(requestWord);
+        if (related != index.relations.end())
+            for (const auto &requestWordSynonim : related->second)
+                addTerm(requestWordSynonim.first, requestWordSynonim.second ? 0.9 : 0.6);
+    }
+
+    // every segment of every term, the largest weighted impact first; inside one term
+    // segments stay in their order, so the next one of a term bounds all its remaining
+    struct Step {
+        double score;
+        uint32_t term, segment;
+    };
+    vector<Step> steps;
+    vector<double> bounds(lists.size(), 0);
+    for (uint32_t term = 0; term < lists.size(); term++) {
+        const auto &segments = lists[term]->segments;
+        // documents of impact 0 add nothing
+        for (uint32_t segment = 0; segment < segments.size(); segment++)
+            if (segments[segment].impact > 0)
+                steps.push_back({weights[term] * lists[term]->score(segments[segment].impact), term, segment});
+        bounds[term] = weights[term] * lists[term]->score(segments[0].impact);
+    }
+    stable_sort(steps.begin(), steps.end(), [](const Step &a, const Step &b) { return a.score > b.score; });
+
+    vector<double> accumulators(index.documents.size(), 0);
+    vector<uint32_t> touched, docIds;
+    vector<double> best;
+    double remaining = 0;
+    for (double bound : bounds)
+        remaining += bound;
+    size_t postings = 0, checked = 0;
+    // segments of every term done so far, always a prefix of its list
+    vector<uint32_t> done(lists.size(), 0);
+    bool stopped = false;
+    for (size_t i = 0; i < steps.size(); i++) {
+        const Step &step = steps[i];
+        done[step.term]++;
+        ImpactIndex::decodeSegment(*lists[step.term], step.segment, &docIds);
+        for (uint32_t docId : docIds) {
+            if (accumulators[docId] == 0)
+                touched.push_back(docId);
+            accumulators[docId] += step.score;
+        }
+        postings += docIds.size();
+
+        const auto &segments = lists[step.term]->segments;
+        double next = step.segment + 1 < segments.size() ?
+                      weights[step.term] * lists[step.term]->score(segments[step.segment + 1].impact) : 0;
+        remaining += next - bounds[step.term];
+        bounds[step.term] = next;
+
+        // The set of the top k is final once no document below it can pass the k-th even
+        // with everything left. A check reads every touched document, so it is done when a
+        // level of impact is over and as many postings were read since the last one.
+        if (!earlyTermination || touched.size() < topK || (i + 1 < steps.size() && steps[i + 1].score == step.score) ||
+            postings - checked < touched.size())
+            continue;
+        checked = postings;
+        best.clear();
+        for (uint32_t docId : touched)
+            best.push_back(accumulators[docId]);
+        nth_element(best.begin(), best.begin() + topK - 1, best.end(), greater<double>());
+        double below = 0;
+        if (best.size() > topK)
+            below = *max_element(best.begin() + topK, best.end());
+        if (best[topK - 1] >= below + remaining) {
+            stopped = true;
+            break;
+        }
+    }
+    if (processed)
+        *processed = postings;
+
+    auto byScore = [](const pair<uint32_t, double> &a, const pair<uint32_t, double> &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    vector<pair<uint32_t, double>> filenameToScore;
+    for (uint32_t docId : touched)
+        filenameToScore.emplace_back(docId, accumulators[docId]);
+    sort(filenameToScore.begin(), filenameToScore.end(), byScore);
+    if (filenameToScore.size() > topK)
+        filenameToScore.resize(topK);
+    if (!stopped)
+        return filenameToScore;
+
+    // The top k is the right set, but its scores lack the segments not read yet. The impact
+    // of every term in these documents is looked up in the full postings and added when its
+    // segment was not done.
+    const auto &documents = index.documents;
+    double averageLength = documents.averageLength();
+    sort(filenameToScore.begin(), filenameToScore.end());
+    for (size_t term = 0; term < lists.size(); term++) {
+        const auto &segments = lists[term]->segments;
+        if (done[term] == segments.size())
+            continue;
+        uint8_t undone = segments[done[term]].impact;
+        PostingCursor cursor(*postingLists[term]);
+        for (auto &scorePair : filenameToScore) {
+            if (!cursor.advance(scorePair.first))
+                break;
+            if (cursor.docId() != scorePair.first)
+                continue;
+            double score = postingScore(documents, averageLength, scorePair.first, cursor.count(),
+                                        postingLists[term]->size());
+            uint8_t impact = ImpactIndex::quantize(score, lists[term]->step);
+            if (impact > 0 && impact <= undone)
+                scorePair.second += weights[term] * lists[term]->score(impact);
+        }
+    }
+    sort(filenameToScore.begin(), filenameToScore.end(), byScore);
+    return filenameToScore;
+}
+
+void buildChampionLists(NGramIndex *index, size_t size) {
+    const auto &documents = index->documents;
+    double averageLength = documents.averageLength();
+    index->champions.clear();
+    // (score, (document id, count))
+    vector<pair<double, pair<uint32_t, uint32_t>>> scored;
+    for (const auto &pairPostings : index->postings) {
+        const PostingList &list = pairPostings.second;
+        scored.clear();
+        for (PostingCursor cursor(list); !cursor.atEnd(); cursor.next())
+            scored.push_back({postingScore(documents, averageLength, cursor.docId(), cursor.count(), list.size()),
+                              {cursor.docId(), cursor.count()}});
+
+        ChampionList &champions = index->champions[pairPostings.first];
+        if (scored.size() > size) {
+            nth_element(scored.begin(), scored.begin() + size, scored.end(), greater<>());
+            champions.rest = max_element(scored.begin() + size, scored.end())->first;
+            scored.resize(size);
+            sort(scored.begin(), scored.end(), [](const pair<double, pair<uint32_t, uint32_t>> &a,
+                                                  const pair<double, pair<uint32_t, uint32_t>> &b) {
+                return a.second < b.second;
+            });
+        }
+        for (const auto &posting : scored) {
+            champions.docIds.push_back(posting.second.first);
+            champions.counts.push_back(posting.second.second);
+        }
+    }
+}
+
+vector<pair<uint32_t, double>> rankByChampions(const NGramIndex &index, const vector<uint64_t> &requestWords,
+                                               size_t topK, bool *fellBack) {
+    const auto &documents = index.documents;
+    double averageLength = documents.averageLength();
+
+    // the same terms and relation weights as rankDocuments
+    vector<const ChampionList*> lists;
+    vector<PostingCursor> cursors;
+    vector<double> weights, idfs;
+    auto addTerm = [&](uint64_t key, double weight) {
+        auto found = index.postings.find(key);
+        if (found == index.postings.end())
+            return;
+        lists.push_back(&index.champions.at(key));
+        cursors.emplace_back(found->second);
+        weights.push_back(weight);
+        idfs.push_back(log10((double) documents.size() / (double) found->second.size()));
+    };
+    for (const auto &requestWord : requestWords) {
+        if (index.postings.find(requestWord) == index.postings.end())
+            continue;
+        addTerm(requestWord, 1.0);
+
+        auto related = index.relations.find(requestWord);
+        if (related != index.relations.end())
+            for (const auto &requestWordSynonim : related->second)
+                addTerm(requestWordSynonim.first, requestWordSynonim.second ? 0.9 : 0.6);
+    }
+
+    // Every document of a champion list gets its exact score, terms it is not a champion
+    // of are looked up in the full postings. Sums go in the order rankDocuments uses.
+    vector<uint32_t> candidates;
+    double unseen = 0;
+    for (size_t i = 0; i < lists.size(); i++) {
+        candidates.insert(candidates.end(), lists[i]->docIds.begin(), lists[i]->docIds.end());
+        unseen += weights[i] * lists[i]->rest;
+    }
+    sort(candidates.begin(), candidates.end());
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+    vector<pair<uint32_t, double>> filenameToScore;
+    vector<size_t> next(lists.size(), 0);
+    for (uint32_t docId : candidates) {
+        int fileSize = documents.length(docId);
+        double score = 0;
+        for (size_t i = 0; i < lists.size(); i++) {
+            const ChampionList &list = *lists[i];
+            while (next[i] < list.docIds.size() && list.docIds[next[i]] < docId)
+                next[i]++;
+            uint32_t count;
+            if (next[i] < list.docIds.size() && list.docIds[next[i]] == docId)
+                count = list.counts[next[i]];
+            else if (cursors[i].advance(docId) && cursors[i].docId() == docId)
+                count = cursors[i].count();
+            else
+                continue;
+            double tf = (double) count / documents.length(docId);
+            score += weights[i] * idfs[i] * (tf * (K1 + 1)) / (tf + K1 * (1 - B + B * fileSize / averageLength));
+        }
+        filenameToScore.emplace_back(docId, score);
+    }
+    sort(filenameToScore.begin(), filenameToScore.end(), [](const pair<uint32_t, double> &a, const pair<uint32_t, double> &b) {
+        return a.second > b.second;
+    });
+
+    // a document outside every champion list scores at most the sum of the rests
+    bool certain = unseen == 0 || (filenameToScore.size() >= topK && filenameToScore[topK - 1].second >= unseen);
+    if (fellBack)
+        *fellBack = !certain;
+    if (!certain)
+        filenameToScore = rankDocuments(index, requestWords);
+    if (filenameToScore.size() > topK)
+        filenameToScore.resize(topK);
+    return filenameToScore;
+}
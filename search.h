@@ -0,0 +1,56 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_SEARCH_H
+#define LABS_SEARCH_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "dictionary.h"
+#include "NGramIndex.h"
+
+// Stored keys of the request terms found in the index. Every word outside quotes is a term,
+// a phrase in "" or «» becomes the longest indexed n-grams it is made of.
+vector<uint64_t> requestTerms(NGramIndex &index, unordered_map<wstring, vector<Word*>> *dictionary,
+                              const wstring &request);
+
+// Lemma ids of every quoted phrase of the request.
+vector<vector<uint32_t>> requestPhrases(NGramIndex &index, unordered_map<wstring, vector<Word*>> *dictionary,
+                                        const wstring &request);
+
+// Documents where the lemmas occur in this order inside one sentence, with the number of
+// occurrences. Only unigram postings are used: documents of the two rarest words are
+// intersected, galloping cursors check the others, then positions are checked. With slop > 0 up to slop words may stand between
+// two neighbouring lemmas.
+vector<pair<uint32_t, uint32_t>> matchPhrase(const NGramIndex &index, const vector<uint32_t> &lemmaIds, int slop = 0);
+
+// BM25 score of every document for terms and their thesaurus relations, best first.
+vector<pair<uint32_t, double>> rankDocuments(const NGramIndex &index, const vector<uint64_t> &terms);
+
+// BM25 of one posting with weight 1, as rankDocuments adds it up.
+double postingScore(const DocumentTable &documents, double averageLength, uint32_t docId, uint32_t count, size_t df);
+
+// Block-max BM25 of every posting list, with the K1 and B of rankDocuments and weight 1.
+void scorePostingBlocks(NGramIndex *index);
+
+// Quantized BM25 impacts of all postings with the K1 and B of rankDocuments, terms weight 1.
+void buildImpactIndex(NGramIndex *index);
+
+// Up to topK best documents by the quantized impacts: segments of all terms and relations are
+// taken highest impact first, and with earlyTermination the rest are skipped once nothing
+// outside the top k can still reach it. processed gets the number of postings read.
+vector<pair<uint32_t, double>> rankByImpact(const NGramIndex &index, const vector<uint64_t> &terms, size_t topK,
+                                            bool earlyTermination = true, size_t *processed = nullptr);
+
+// Champion lists of size documents for every n-gram, replacing any built before.
+void buildChampionLists(NGramIndex *index, size_t size);
+
+// Up to topK best documents with exact BM25 scores. Only documents of the champion lists of
+// the terms and their relations are scored; when some document outside them could still
+// reach the top k, every document is scored by rankDocuments instead. fellBack tells which.
+vector<pair<uint32_t, double>> rankByChampions(const NGramIndex &index, const vector<uint64_t> &terms, size_t topK,
+                                               bool *fellBack = nullptr);
+
+#endif //LABS_SEARCH_H
@@ -0,0 +1,305 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#include "textreader.h"
+#include "filemap.h"
+#include "json.hpp"
+
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <functional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef TEXTREADER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TEXTREADER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+const size_t CHUNK_SIZE = 1 << 20;
+const size_t READ_BUFFER_SIZE = 1 << 17;
+
+static bool endsWith(const string &str, const string &suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static string stripCompression(const string &path) {
+    if (endsWith(path, ".gz"))
+        return path.substr(0, path.size() - 3);
+    if (endsWith(path, ".zst"))
+        return path.substr(0, path.size() - 4);
+    return path;
+}
+
+bool isCompressedPath(const string &path) {
+    return endsWith(path, ".gz") || endsWith(path, ".zst");
+}
+
+static size_t fileSize(const string &path) {
+    struct stat sb;
+    if (stat(path.c_str(), &sb) == -1)
+        return 0;
+    return sb.st_size;
+}
+
+// Calls sink with consecutive blocks of decompressed data.
+static bool decompressFile(const string &path, const function<void(const char *, size_t)> &sink) {
+    vector<char> buffer(READ_BUFFER_SIZE);
+
+    if (endsWith(path, ".zst")) {
+#ifdef TEXTREADER_HAVE_ZSTD
+        FILE *file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        ZSTD_DStream *stream = ZSTD_createDStream();
+        ZSTD_initDStream(stream);
+        vector<char> input(ZSTD_DStreamInSize());
+        size_t readCount;
+        bool ok = true;
+        while (ok && (readCount = fread(input.data(), 1, input.size(), file)) > 0) {
+            ZSTD_inBuffer in = {input.data(), readCount, 0};
+            while (in.pos < in.size) {
+                ZSTD_outBuffer out = {buffer.data(), buffer.size(), 0};
+                size_t result = ZSTD_decompressStream(stream, &out, &in);
+                if (ZSTD_isError(result)) {
+                    cerr << path << ": " << ZSTD_getErrorName(result) << endl;
+                    ok = false;
+                    break;
+                }
+                sink(buffer.data(), out.pos);
+            }
+        }
+        ZSTD_freeDStream(stream);
+        fclose(file);
+        return ok;
+#else
+        cerr << path << ": built without zstd support" << endl;
+        return false;
+#endif
+    }
+
+#ifdef TEXTREADER_HAVE_ZLIB
+    // gzread passes uncompressed files through as is
+    gzFile file = gzopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    gzbuffer(file, READ_BUFFER_SIZE);
+    int readCount;
+    while ((readCount = gzread(file, buffer.data(), (unsigned) buffer.size())) > 0)
+        sink(buffer.data(), readCount);
+    gzclose(file);
+    return readCount == 0;
+#else
+    if (endsWith(path, ".gz")) {
+        cerr << path << ": built without zlib support" << endl;
+        return false;
+    }
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    size_t readCount;
+    while ((readCount = fread(buffer.data(), 1, buffer.size(), file)) > 0)
+        sink(buffer.data(), readCount);
+    fclose(file);
+    return true;
+#endif
+}
+
+CorpusReader::CorpusReader(const vector<string> &files, size_t queueSize) {
+    this->files = files;
+    this->queueSize = queueSize;
+    producer = thread(&CorpusReader::produce, this);
+}
+
+CorpusReader::~CorpusReader() {
+    {
+        unique_lock<mutex> lock(queueMutex);
+        stopped = true;
+    }
+    queueChanged.notify_all();
+    producer.join();
+    for (auto &chunk : queue)
+        release(chunk);
+}
+
+bool CorpusReader::next(TextChunk &chunk) {
+    unique_lock<mutex> lock(queueMutex);
+    queueChanged.wait(lock, [this] { return !queue.empty() || finished; });
+    if (queue.empty())
+        return false;
+
+    chunk = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+    queueChanged.notify_all();
+
+    if (!chunk.data) {
+        chunk.data = chunk.storage.data();
+        chunk.length = chunk.storage.size();
+    }
+    return true;
+}
+
+void CorpusReader::release(TextChunk &chunk) {
+    if (chunk.mapped && chunk.last)
+        munmap(chunk.mapped, chunk.mappedLength);
+    chunk.mapped = nullptr;
+}
+
+void CorpusReader::push(TextChunk &&chunk) {
+    unique_lock<mutex> lock(queueMutex);
+    queueChanged.wait(lock, [this] { return queue.size() < queueSize || stopped; });
+    if (stopped) {
+        release(chunk);
+        return;
+    }
+    queue.push_back(std::move(chunk));
+    lock.unlock();
+    queueChanged.notify_all();
+}
+
+void CorpusReader::produce() {
+    for (const auto &path : files) {
+        if (stopped)
+            break;
+
+        if (endsWith(stripCompression(path), ".jsonl"))
+            readStream(path, true);
+        else if (isCompressedPath(path))
+            readStream(path, false);
+        else
+            readPlain(path);
+    }
+
+    {
+        unique_lock<mutex> lock(queueMutex);
+        finished = true;
+    }
+    queueChanged.notify_all();
+}
+
+void CorpusReader::readPlain(const string &path) {
+    size_t length;
+    char *addr = map_file(path.c_str(), length);
+    compressedBytes += length;
+    textBytes += length;
+    documentCount++;
+
+    const char *filePtr = addr;
+    const char *lastChar = addr + length;
+    bool first = true;
+    while (first || filePtr != lastChar) {
+        const char *cut = lastChar;
+        if (lastChar - filePtr > (ptrdiff_t) CHUNK_SIZE) {
+            auto lineEnd = static_cast<const char *>(memchr(filePtr + CHUNK_SIZE, '\n',
+                                                            lastChar - filePtr - CHUNK_SIZE));
+            if (lineEnd)
+                cut = lineEnd + 1;
+        }
+
+        TextChunk chunk;
+        chunk.docName = path;
+        chunk.data = filePtr;
+        chunk.length = cut - filePtr;
+        chunk.first = first;
+        chunk.last = cut == lastChar;
+        if (chunk.last) {
+            chunk.mapped = addr;
+            chunk.mappedLength = length;
+        }
+        push(std::move(chunk));
+
+        filePtr = cut;
+        first = false;
+        // the consumer is gone before the last chunk took the mapping over
+        if (stopped && filePtr != lastChar) {
+            munmap(addr, length);
+            return;
+        }
+    }
+}
+
+void CorpusReader::readStream(const string &path, bool jsonLines) {
+    string pending;
+    bool first = true;
+    size_t lineNumber = 0;
+
+    auto sink = [&](const char *data, size_t length) {
+        pending.append(data, length);
+        textBytes += length;
+        if (jsonLines)
+            emitJsonLines(path, pending, lineNumber, false);
+        else
+            emitLines(path, pending, first, false);
+    };
+    if (!decompressFile(path, sink))
+        cerr << "Failed to read " << path << endl;
+    compressedBytes += fileSize(path);
+
+    if (jsonLines) {
+        emitJsonLines(path, pending, lineNumber, true);
+    } else {
+        emitLines(path, pending, first, true);
+        documentCount++;
+    }
+}
+
+void CorpusReader::emitLines(const string &docName, string &pending, bool &first, bool flush) {
+    if (!flush && pending.size() < CHUNK_SIZE)
+        return;
+
+    size_t cut = pending.size();
+    if (!flush) {
+        size_t lineEnd = pending.rfind('\n');
+        if (lineEnd == string::npos)
+            return;
+        cut = lineEnd + 1;
+    }
+
+    TextChunk chunk;
+    chunk.docName = docName;
+    chunk.storage = pending.substr(0, cut);
+    chunk.first = first;
+    chunk.last = flush;
+    pending.erase(0, cut);
+    push(std::move(chunk));
+    first = false;
+}
+
+void CorpusReader::emitJsonLines(const string &path, string &pending, size_t &lineNumber, bool flush) {
+    size_t begin = 0;
+    while (begin < pending.size()) {
+        size_t lineEnd = pending.find('\n', begin);
+        if (lineEnd == string::npos) {
+            if (!flush)
+                break;
+            lineEnd = pending.size();
+        }
+
+        lineNumber++;
+        auto document = nlohmann::json::parse(pending.begin() + begin, pending.begin() + lineEnd,
+                                              nullptr, false);
+        begin = lineEnd + 1;
+        if (document.is_discarded() || !document.is_object() || !document.contains("text") ||
+            !document["text"].is_string())
+            continue;
+
+        string id = to_string(lineNumber);
+        if (document.contains("id"))
+            id = document["id"].is_string() ? document["id"].get<string>() : document["id"].dump();
+
+        TextChunk chunk;
+        chunk.docName = path + "#" + id;
+        chunk.storage = document["text"].get<string>();
+        chunk.first = true;
+        chunk.last = true;
+        push(std::move(chunk));
+        documentCount++;
+    }
+    pending.erase(0, min(begin, pending.size()));
+}
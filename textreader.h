@@ -0,0 +1,73 @@
+//
+// Created by Roman Titkov on 19.10.2026.
+//
+
+#ifndef LABS_TEXTREADER_H
+#define LABS_TEXTREADER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#if __has_include(<zlib.h>)
+#define TEXTREADER_HAVE_ZLIB 1
+#endif
+#if __has_include(<zstd.h>)
+#define TEXTREADER_HAVE_ZSTD 1
+#endif
+
+using namespace std;
+
+// Piece of a document text that always ends on a line boundary.
+// Plain files are not copied: data points into the mapped file and the
+// mapping is released together with the last chunk of the document.
+struct TextChunk {
+    string docName;
+    string storage;
+    const char *data = nullptr;
+    size_t length = 0;
+    char *mapped = nullptr;
+    size_t mappedLength = 0;
+    bool first = false;
+    bool last = false;
+};
+
+// Reads .txt, .gz, .zst and .jsonl(.gz/.zst) corpora on a separate thread,
+// so that decompression runs in parallel with tokenization.
+// Every line of a .jsonl file is a document: {"id": ..., "text": ...}.
+class CorpusReader {
+public:
+    size_t compressedBytes = 0;
+    size_t textBytes = 0;
+    size_t documentCount = 0;
+
+    explicit CorpusReader(const vector<string> &files, size_t queueSize = 16);
+    ~CorpusReader();
+
+    bool next(TextChunk &chunk);
+    static void release(TextChunk &chunk);
+
+private:
+    vector<string> files;
+    deque<TextChunk> queue;
+    size_t queueSize;
+    bool finished = false;
+    atomic<bool> stopped{false};
+    mutex queueMutex;
+    condition_variable queueChanged;
+    thread producer;
+
+    void produce();
+    void push(TextChunk &&chunk);
+    void readPlain(const string &path);
+    void readStream(const string &path, bool jsonLines);
+    void emitLines(const string &docName, string &pending, bool &first, bool flush);
+    void emitJsonLines(const string &path, string &pending, size_t &lineNumber, bool flush);
+};
+
+bool isCompressedPath(const string &path);
+#endif //LABS_TEXTREADER_H